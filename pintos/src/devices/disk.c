@@ -86,7 +86,7 @@ static void reset_channel (struct channel *);
 static bool check_device_type (struct disk *);
 static void identify_ata_device (struct disk *);
 
-static void select_sector (struct disk *, disk_sector_t);
+static void select_sectors (struct disk *, disk_sector_t, size_t);
 static void issue_pio_command (struct channel *, uint8_t command);
 static void input_sector (struct channel *, void *);
 static void output_sector (struct channel *, const void *);
@@ -218,54 +218,94 @@ disk_size (struct disk *d)
    per-disk locking is unneeded. */
 void
 disk_read (struct disk *d, disk_sector_t sec_no, void *buffer) 
+{
+  disk_read_multiple (d, sec_no, buffer, 1);
+}
+
+/* Write sector SEC_NO to disk D from BUFFER, which must contain
+   DISK_SECTOR_SIZE bytes.  Returns after the disk has
+   acknowledged receiving the data.
+   Internally synchronizes accesses to disks, so external
+   per-disk locking is unneeded. */
+void
+disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer)
+{
+  disk_write_multiple (d, sec_no, buffer, 1);
+}
+
+/* Reads the SECTOR_CNT sectors starting at SEC_NO from disk D
+   into BUFFER, which must have room for that many sectors, with
+   a single command.  SECTOR_CNT must be between 1 and 256. */
+void
+disk_read_multiple (struct disk *d, disk_sector_t sec_no, void *buffer,
+                    size_t sector_cnt)
+{
+  disk_read_scattered (d, sec_no, &buffer, 1, sector_cnt);
+}
+
+/* Reads BUFFER_CNT groups of SECTOR_CNT sectors each, starting at
+   SEC_NO on disk D, into BUFFERS[0], BUFFERS[1], and so on, with
+   a single command.  BUFFER_CNT * SECTOR_CNT must be between 1
+   and 256. */
+void
+disk_read_scattered (struct disk *d, disk_sector_t sec_no,
+                     void *buffers[], size_t buffer_cnt, size_t sector_cnt)
 {
   struct channel *c;
+  size_t total = buffer_cnt * sector_cnt;
+  size_t i;
   
   ASSERT (d != NULL);
-  ASSERT (buffer != NULL);
+  ASSERT (buffers != NULL);
+  ASSERT (total >= 1 && total <= 256);
 
   c = d->channel;
   lock_acquire (&c->lock);
-  select_sector (d, sec_no);
+  select_sectors (d, sec_no, total);
   issue_pio_command (c, CMD_READ_SECTOR_RETRY);
-  sema_down (&c->completion_wait);
-  if (!wait_while_busy (d))
-    PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name, sec_no);
-  input_sector (c, buffer);
-  d->read_cnt++;
+  for (i = 0; i < total; i++)
+    {
+      /* The disk interrupts as each sector becomes ready. */
+      sema_down (&c->completion_wait);
+      if (!wait_while_busy (d))
+        PANIC ("%s: disk read failed, sector=%"PRDSNu,
+               d->name, sec_no + i);
+      input_sector (c, (uint8_t *) buffers[i / sector_cnt]
+                       + i % sector_cnt * DISK_SECTOR_SIZE);
+    }
+  d->read_cnt += total;
   lock_release (&c->lock);
 }
 
-/* Write sector SEC_NO to disk D from BUFFER, which must contain
-   DISK_SECTOR_SIZE bytes.  Returns after the disk has
-   acknowledged receiving the data.
-   Internally synchronizes accesses to disks, so external
-   per-disk locking is unneeded. */
+/* Writes the SECTOR_CNT sectors starting at SEC_NO on disk D from
+   BUFFER, which must contain that many sectors, with a single
+   command.  SECTOR_CNT must be between 1 and 256.  Returns after
+   the disk has acknowledged receiving the data. */
 void
-disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer)
+disk_write_multiple (struct disk *d, disk_sector_t sec_no,
+                     const void *buffer, size_t sector_cnt)
 {
   struct channel *c;
+  size_t i;
   
   ASSERT (d != NULL);
   ASSERT (buffer != NULL);
 
   c = d->channel;
   lock_acquire (&c->lock);
-  select_sector (d, sec_no);
+  select_sectors (d, sec_no, sector_cnt);
   issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
-  if (!wait_while_busy (d))
-    PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
-  output_sector (c, buffer);
-  sema_down (&c->completion_wait);
-  d->write_cnt++;
-<<<<<<< HEAD
-
-  lock_release (&c->lock);
-//    ASSERT(0);
-
-=======
+  for (i = 0; i < sector_cnt; i++)
+    {
+      /* The disk interrupts as it takes each sector. */
+      if (!wait_while_busy (d))
+        PANIC ("%s: disk write failed, sector=%"PRDSNu,
+               d->name, sec_no + i);
+      output_sector (c, (const uint8_t *) buffer + i * DISK_SECTOR_SIZE);
+      sema_down (&c->completion_wait);
+    }
+  d->write_cnt += sector_cnt;
   lock_release (&c->lock);
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
 }
 
 /* Disk detection and identification. */
@@ -433,18 +473,19 @@ print_ata_string (char *string, size_t size)
 }
 
 /* Selects device D, waiting for it to become ready, and then
-   writes SEC_NO to the disk's sector selection registers.  (We
-   use LBA mode.) */
+   writes SEC_NO and SECTOR_CNT to the disk's sector selection
+   registers.  (We use LBA mode.) */
 static void
-select_sector (struct disk *d, disk_sector_t sec_no) 
+select_sectors (struct disk *d, disk_sector_t sec_no, size_t sector_cnt) 
 {
   struct channel *c = d->channel;
 
-  ASSERT (sec_no < d->capacity);
-  ASSERT (sec_no < (1UL << 28));
+  ASSERT (sector_cnt >= 1 && sector_cnt <= 256);
+  ASSERT (sec_no + sector_cnt <= d->capacity);
+  ASSERT (sec_no + sector_cnt <= (1UL << 28));
   
   select_device_wait (d);
-  outb (reg_nsect (c), 1);
+  outb (reg_nsect (c), sector_cnt);     /* 256 wraps to 0, meaning 256. */
   outb (reg_lbal (c), sec_no);
   outb (reg_lbam (c), sec_no >> 8);
   outb (reg_lbah (c), (sec_no >> 16));
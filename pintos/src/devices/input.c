@@ -1,16 +1,35 @@
 #include "devices/input.h"
 #include <debug.h>
+#include <list.h>
 #include "devices/intq.h"
 #include "devices/serial.h"
+#include "devices/timer.h"
+#include "threads/thread.h"
 
 /* Stores keys from the keyboard and serial port. */
 static struct intq buffer;
 
+/* Number of keys ever added to the buffer. */
+static unsigned key_cnt;
+
+/* A thread blocked in input_wait() or input_wait_since(). */
+struct input_waiter
+  {
+    struct list_elem elem;      /* Element in waiters. */
+    struct thread *thread;      /* The waiting thread. */
+    int64_t deadline;           /* Tick to stop waiting at, or -1. */
+  };
+
+/* Threads waiting for a key without reading it.  Unlike the
+   buffer's own not_empty waiter, any number may wait at once. */
+static struct list waiters;
+
 /* Initializes the input buffer. */
 void
 input_init (void) 
 {
   intq_init (&buffer);
+  list_init (&waiters);
 }
 
 /* Adds a key to the input buffer.
@@ -22,7 +41,14 @@ input_putc (uint8_t key)
   ASSERT (!intq_full (&buffer));
 
   intq_putc (&buffer, key);
+  key_cnt++;
   serial_notify ();
+
+  while (!list_empty (&waiters))
+    {
+      struct list_elem *e = list_pop_front (&waiters);
+      thread_unblock (list_entry (e, struct input_waiter, elem)->thread);
+    }
 }
 
 /* Retrieves a key from the input buffer.
@@ -50,3 +76,86 @@ input_full (void)
   ASSERT (intr_get_level () == INTR_OFF);
   return intq_full (&buffer);
 }
+
+/* Returns true if the input buffer is empty,
+   false otherwise.
+   Interrupts must be off. */
+bool
+input_empty (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  return intq_empty (&buffer);
+}
+
+/* Waits until the input buffer is nonempty, without removing
+   anything from it. */
+void
+input_wait (void) 
+{
+  enum intr_level old_level;
+  struct input_waiter w;
+
+  old_level = intr_disable ();
+  while (intq_empty (&buffer))
+    {
+      w.thread = thread_current ();
+      w.deadline = -1;
+      list_push_back (&waiters, &w.elem);
+      thread_block ();
+    }
+  intr_set_level (old_level);
+}
+
+/* Returns a stamp for input_wait_since() that identifies the
+   keys added to the input buffer so far. */
+unsigned
+input_stamp (void) 
+{
+  return key_cnt;
+}
+
+/* Waits until a key has been added to the input buffer since
+   input_stamp() returned STAMP or, if DEADLINE is nonnegative,
+   until timer tick DEADLINE.  Returns true if a key was added,
+   false if the deadline came first. */
+bool
+input_wait_since (unsigned stamp, int64_t deadline) 
+{
+  enum intr_level old_level;
+  struct input_waiter w;
+  bool added;
+
+  old_level = intr_disable ();
+  while (key_cnt == stamp && (deadline < 0 || timer_ticks () < deadline))
+    {
+      w.thread = thread_current ();
+      w.deadline = deadline;
+      list_push_back (&waiters, &w.elem);
+      thread_block ();
+    }
+  added = key_cnt != stamp;
+  intr_set_level (old_level);
+  return added;
+}
+
+/* Wakes the threads in input_wait_since() whose deadline is
+   timer tick NOW or earlier.  Called by the timer interrupt
+   handler on each tick. */
+void
+input_tick (int64_t now) 
+{
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (&waiters); e != list_end (&waiters); )
+    {
+      struct input_waiter *w = list_entry (e, struct input_waiter, elem);
+      e = list_next (e);
+      if (w->deadline >= 0 && w->deadline <= now)
+        {
+          list_remove (&w->elem);
+          thread_unblock (w->thread);
+        }
+    }
+}
@@ -8,5 +8,10 @@ void input_init (void);
 void input_putc (uint8_t);
 uint8_t input_getc (void);
 bool input_full (void);
+bool input_empty (void);
+void input_wait (void);
+unsigned input_stamp (void);
+bool input_wait_since (unsigned stamp, int64_t deadline);
+void input_tick (int64_t now);
 
 #endif /* devices/input.h */
@@ -0,0 +1,57 @@
+/* nullbench.c
+
+   Times a system call that does nothing, once entering the
+   kernel through `int $0x30' and once through `sysenter', and
+   prints the average number of CPU cycles per call for each. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+/* Reads the CPU's time-stamp counter. */
+static uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Returns the average cycles taken by each of ITERATIONS null
+   system calls. */
+static uint64_t
+time_null (int iterations)
+{
+  uint64_t start;
+  int i;
+
+  start = rdtsc ();
+  for (i = 0; i < iterations; i++)
+    null_syscall ();
+  return (rdtsc () - start) / iterations;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int iterations = argc > 1 ? atoi (argv[1]) : 100000;
+  bool sysenter = syscall_sysenter;
+
+  if (iterations <= 0)
+    {
+      printf ("usage: nullbench [ITERATIONS]\n");
+      return EXIT_FAILURE;
+    }
+
+  syscall_sysenter = false;
+  printf ("int $0x30: %llu cycles/call\n", time_null (iterations));
+  if (sysenter)
+    {
+      syscall_sysenter = true;
+      printf ("sysenter:  %llu cycles/call\n", time_null (iterations));
+    }
+  else
+    printf ("sysenter:  not supported by this CPU\n");
+  return EXIT_SUCCESS;
+}
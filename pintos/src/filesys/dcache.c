@@ -0,0 +1,166 @@
+#include "filesys/dcache.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <string.h>
+#include "filesys/directory.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* Maximum number of cached directory entries. */
+#define DCACHE_CNT 256
+
+/* A cached result of looking up NAME in directory DIR. */
+struct dentry
+  {
+    struct hash_elem hash_elem;         /* Element in dcache. */
+    struct list_elem lru_elem;          /* Element in dcache_lru. */
+    disk_sector_t dir;                  /* Directory's inode sector. */
+    char name[NAME_MAX + 1];            /* Name looked up in DIR. */
+    disk_sector_t sector;               /* Inode sector, or DCACHE_NEGATIVE. */
+  };
+
+/* Cached entries, keyed by (DIR, NAME). */
+static struct hash dcache;
+
+/* The same entries, most recently used first. */
+static struct list dcache_lru;
+
+/* Protects dcache and dcache_lru. */
+static struct lock dcache_lock;
+
+static hash_hash_func dentry_hash;
+static hash_less_func dentry_less;
+
+/* Initializes the directory entry cache. */
+void
+dcache_init (void)
+{
+  hash_init (&dcache, dentry_hash, dentry_less, NULL);
+  list_init (&dcache_lru);
+  lock_init (&dcache_lock);
+}
+
+/* Returns the cached entry for NAME in DIR, or a null pointer.
+   NAME longer than NAME_MAX is never cached. */
+static struct dentry *
+dentry_find (disk_sector_t dir, const char *name)
+{
+  struct dentry key;
+  struct hash_elem *e;
+
+  if (strlen (name) > NAME_MAX)
+    return NULL;
+  key.dir = dir;
+  strlcpy (key.name, name, sizeof key.name);
+  e = hash_find (&dcache, &key.hash_elem);
+  return e != NULL ? hash_entry (e, struct dentry, hash_elem) : NULL;
+}
+
+/* Looks up NAME in the directory whose inode is in sector DIR.
+   On a hit returns true and sets *SECTORP to the inode sector
+   NAME refers to, or to DCACHE_NEGATIVE if DIR is known to have
+   no entry NAME.  Returns false if nothing is cached. */
+bool
+dcache_lookup (disk_sector_t dir, const char *name, disk_sector_t *sectorp)
+{
+  struct dentry *d;
+
+  lock_acquire (&dcache_lock);
+  d = dentry_find (dir, name);
+  if (d != NULL)
+    {
+      list_remove (&d->lru_elem);
+      list_push_front (&dcache_lru, &d->lru_elem);
+      *sectorp = d->sector;
+    }
+  lock_release (&dcache_lock);
+
+  return d != NULL;
+}
+
+/* Records that NAME in the directory whose inode is in sector
+   DIR refers to inode SECTOR, or does not exist if SECTOR is
+   DCACHE_NEGATIVE, replacing any older entry.  Evicts the least
+   recently used entry if the cache is full. */
+void
+dcache_insert (disk_sector_t dir, const char *name, disk_sector_t sector)
+{
+  struct dentry *d;
+
+  if (strlen (name) > NAME_MAX)
+    return;
+
+  lock_acquire (&dcache_lock);
+  d = dentry_find (dir, name);
+  if (d != NULL)
+    list_remove (&d->lru_elem);
+  else
+    {
+      if (hash_size (&dcache) >= DCACHE_CNT)
+        {
+          /* Reuse the least recently used entry. */
+          d = list_entry (list_back (&dcache_lru), struct dentry, lru_elem);
+          list_remove (&d->lru_elem);
+          hash_delete (&dcache, &d->hash_elem);
+        }
+      else
+        d = malloc (sizeof *d);
+      if (d != NULL)
+        {
+          d->dir = dir;
+          strlcpy (d->name, name, sizeof d->name);
+          hash_insert (&dcache, &d->hash_elem);
+        }
+    }
+
+  if (d != NULL)
+    {
+      d->sector = sector;
+      list_push_front (&dcache_lru, &d->lru_elem);
+    }
+  lock_release (&dcache_lock);
+}
+
+/* Forgets every cached entry for the directory whose inode is in
+   sector DIR, which is being deleted and whose sector may be
+   reused by an unrelated directory. */
+void
+dcache_purge (disk_sector_t dir)
+{
+  struct list_elem *e;
+
+  lock_acquire (&dcache_lock);
+  for (e = list_begin (&dcache_lru); e != list_end (&dcache_lru); )
+    {
+      struct dentry *d = list_entry (e, struct dentry, lru_elem);
+      e = list_next (e);
+      if (d->dir == dir)
+        {
+          list_remove (&d->lru_elem);
+          hash_delete (&dcache, &d->hash_elem);
+          free (d);
+        }
+    }
+  lock_release (&dcache_lock);
+}
+
+/* Returns a hash value for dentry E. */
+static unsigned
+dentry_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct dentry *d = hash_entry (e, struct dentry, hash_elem);
+  return hash_string (d->name) ^ hash_int (d->dir);
+}
+
+/* Returns true if dentry A precedes dentry B. */
+static bool
+dentry_less (const struct hash_elem *a_, const struct hash_elem *b_,
+             void *aux UNUSED)
+{
+  const struct dentry *a = hash_entry (a_, struct dentry, hash_elem);
+  const struct dentry *b = hash_entry (b_, struct dentry, hash_elem);
+  if (a->dir != b->dir)
+    return a->dir < b->dir;
+  return strcmp (a->name, b->name) < 0;
+}
@@ -0,0 +1,18 @@
+#ifndef FILESYS_DCACHE_H
+#define FILESYS_DCACHE_H
+
+#include <stdbool.h>
+#include "devices/disk.h"
+
+/* Sector recorded for a name known not to exist.  Sector 0 holds
+   the free map inode, so no directory entry can refer to it. */
+#define DCACHE_NEGATIVE 0
+
+void dcache_init (void);
+bool dcache_lookup (disk_sector_t dir, const char *name,
+                    disk_sector_t *sectorp);
+void dcache_insert (disk_sector_t dir, const char *name,
+                    disk_sector_t sector);
+void dcache_purge (disk_sector_t dir);
+
+#endif /* filesys/dcache.h */
@@ -1,7 +1,12 @@
 #include "filesys/directory.h"
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include <list.h>
+#include <hash.h>
+#include <round.h>
+#include <syscall-nr.h>
+#include "filesys/dcache.h"
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
@@ -21,12 +26,84 @@ struct dir_entry
     bool in_use;                        /* In use or free? */
   };
 
+/* A directory starts out as a flat array of dir_entry that is
+   searched linearly.  Once it fills up with more than
+   DIR_LINEAR_MAX entries it is converted to a hashed layout made
+   of sector-sized blocks:
+
+     block 0                    struct dir_header
+     blocks 1...bucket_cnt      first block of each bucket
+     later blocks               overflow blocks, chained by NEXT
+
+   A name lives in bucket hash_string(name) % bucket_cnt.  Blocks
+   at or beyond block_cnt are leftovers from before a rehash. */
+#define DIR_MAGIC 0x48444952            /* "HDIR": hashed directory. */
+#define DIR_LINEAR_MAX 32               /* Most entries in a linear dir. */
+#define DIR_FIRST_BUCKETS 8             /* Buckets after conversion. */
+#define DIR_BLOCK_ENTRIES 25            /* Entries in one block. */
+
+/* Block 0 of a hashed directory. */
+struct dir_header
+  {
+    uint32_t magic;                     /* DIR_MAGIC. */
+    uint32_t bucket_cnt;                /* Number of buckets, power of 2. */
+    uint32_t block_cnt;                 /* Blocks in use, header included. */
+    uint32_t entry_cnt;                 /* Entries in use. */
+  };
+
+/* A bucket or overflow block of a hashed directory. */
+struct dir_block
+  {
+    uint32_t next;                      /* Next block in chain, 0 if none. */
+    struct dir_entry entries[DIR_BLOCK_ENTRIES];
+    uint8_t unused[DISK_SECTOR_SIZE - sizeof (uint32_t)
+                   - DIR_BLOCK_ENTRIES * sizeof (struct dir_entry)];
+  };
+
+/* Reads DIR's header into *H and returns true if DIR is hashed,
+   false if it is linear. */
+static bool
+read_header (const struct dir *dir, struct dir_header *h)
+{
+  return (inode_read_at (dir->inode, h, sizeof *h, 0) == sizeof *h
+          && h->magic == DIR_MAGIC);
+}
+
+/* Returns the byte offset of entry I in block BLOCK. */
+static off_t
+entry_ofs (uint32_t block, size_t i)
+{
+  return ((off_t) block * DISK_SECTOR_SIZE
+          + offsetof (struct dir_block, entries)
+          + i * sizeof (struct dir_entry));
+}
+
+/* Returns the first block of NAME's bucket under header H. */
+static uint32_t
+bucket_block (const struct dir_header *h, const char *name)
+{
+  return 1 + (hash_string (name) & (h->bucket_cnt - 1));
+}
+
 /* Creates a directory with space for ENTRY_CNT entries in the
-   given SECTOR.  Returns true if successful, false on failure. */
+   given SECTOR, whose "." entry refers to itself and whose ".."
+   entry refers to the directory in PARENT_SECTOR.
+   Returns true if successful, false on failure. */
 bool
-dir_create (disk_sector_t sector, size_t entry_cnt) 
+dir_create (disk_sector_t sector, size_t entry_cnt,
+            disk_sector_t parent_sector) 
 {
-  return inode_create (sector, entry_cnt * sizeof (struct dir_entry));
+  struct dir *dir;
+  bool success;
+
+  if (!inode_create (sector, entry_cnt * sizeof (struct dir_entry), true))
+    return false;
+  dir = dir_open (inode_open (sector));
+  success = (dir != NULL
+             && dir_add (dir, ".", sector)
+             && dir_add (dir, "..", parent_sector));
+  dir_close (dir);
+  return success;
 }
 
 /* Opens and returns the directory for the given INODE, of which
@@ -83,21 +160,46 @@ dir_get_inode (struct dir *dir)
   return dir->inode;
 }
 
-/* Searches DIR for a file with the given NAME.
-   If successful, returns true, sets *EP to the directory entry
-   if EP is non-null, and sets *OFSP to the byte offset of the
-   directory entry if OFSP is non-null.
-   otherwise, returns false and ignores EP and OFSP. */
+/* Reads the entry slot at or after *POSP in DIR, in use or not,
+   into *EP and advances *POSP past it.  H must be DIR's header if
+   DIR is hashed, otherwise a null pointer.
+   Returns false at the end of the directory. */
 static bool
-lookup (const struct dir *dir, const char *name,
-        struct dir_entry *ep, off_t *ofsp) 
+next_entry (const struct dir *dir, const struct dir_header *h,
+            off_t *posp, struct dir_entry *ep)
+{
+  off_t pos = *posp;
+
+  if (h != NULL)
+    {
+      /* Skip the header block and the tail of each block. */
+      uint32_t block = pos / DISK_SECTOR_SIZE;
+      if (block == 0 || pos >= entry_ofs (block, DIR_BLOCK_ENTRIES))
+        block++;
+      if (pos < entry_ofs (block, 0))
+        pos = entry_ofs (block, 0);
+      if (block >= h->block_cnt)
+        return false;
+    }
+
+  if (inode_read_at (dir->inode, ep, sizeof *ep, pos) != sizeof *ep)
+    return false;
+  *posp = pos + sizeof *ep;
+  return true;
+}
+
+/* Searches linear directory DIR for NAME, as lookup() does.
+   If FREEP is non-null, sets *FREEP to the offset of the first
+   free slot, or to the end of the directory if there is none. */
+static bool
+linear_lookup (const struct dir *dir, const char *name,
+               struct dir_entry *ep, off_t *ofsp, off_t *freep)
 {
   struct dir_entry e;
   size_t ofs;
-  
-  ASSERT (dir != NULL);
-  ASSERT (name != NULL);
 
+  if (freep != NULL)
+    *freep = -1;
   for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
        ofs += sizeof e) 
     if (e.in_use && !strcmp (name, e.name)) 
@@ -108,9 +210,193 @@ lookup (const struct dir *dir, const char *name,
           *ofsp = ofs;
         return true;
       }
+    else if (!e.in_use && freep != NULL && *freep == -1)
+      *freep = ofs;
+
+  /* inode_read_at() will only return a short read at end of file.
+     Otherwise, we'd need to verify that we didn't get a short
+     read due to something intermittent such as low memory. */
+  if (freep != NULL && *freep == -1)
+    *freep = ofs;
   return false;
 }
 
+/* Searches hashed directory DIR, whose header is H, for NAME, as
+   lookup() does, reading only NAME's bucket chain.
+   If FREEP is non-null, sets *FREEP to the offset of the first
+   free slot in the chain, or -1 if the chain is full, and sets
+   *LASTP to the last block in the chain, or to 0 if memory could
+   not be allocated or the chain could not be read.  Block 0 holds
+   the header, so it is never part of a chain. */
+static bool
+hashed_lookup (const struct dir *dir, const struct dir_header *h,
+               const char *name, struct dir_entry *ep, off_t *ofsp,
+               off_t *freep, uint32_t *lastp)
+{
+  struct dir_block *b;
+  uint32_t block;
+  bool found = false;
+
+  if (freep != NULL)
+    *freep = -1;
+  if (lastp != NULL)
+    *lastp = 0;
+  b = malloc (sizeof *b);
+  if (b == NULL)
+    return false;
+
+  for (block = bucket_block (h, name); block != 0 && !found;
+       block = b->next)
+    {
+      size_t i;
+
+      if (inode_read_at (dir->inode, b, sizeof *b,
+                         (off_t) block * DISK_SECTOR_SIZE) != sizeof *b)
+        {
+          if (lastp != NULL)
+            *lastp = 0;
+          break;
+        }
+      if (lastp != NULL)
+        *lastp = block;
+      for (i = 0; i < DIR_BLOCK_ENTRIES; i++)
+        {
+          struct dir_entry *e = &b->entries[i];
+          if (e->in_use && !strcmp (name, e->name))
+            {
+              if (ep != NULL)
+                *ep = *e;
+              if (ofsp != NULL)
+                *ofsp = entry_ofs (block, i);
+              found = true;
+              break;
+            }
+          else if (!e->in_use && freep != NULL && *freep == -1)
+            *freep = entry_ofs (block, i);
+        }
+    }
+  free (b);
+  return found;
+}
+
+/* Rewrites DIR, linear or hashed, in hashed layout with
+   BUCKET_CNT buckets, keeping every entry in use.
+   Returns true if successful, false on failure. */
+static bool
+rehash (struct dir *dir, uint32_t bucket_cnt)
+{
+  struct dir_header h;
+  struct dir_entry *entries;
+  uint32_t *buckets = NULL;
+  struct dir_block *b = NULL;
+  size_t cnt, max_cnt, i;
+  uint32_t k, block_cnt, next_block;
+  off_t pos;
+  bool hashed, success = false;
+
+  /* Collect the entries in use. */
+  hashed = read_header (dir, &h);
+  max_cnt = inode_length (dir->inode) / sizeof *entries;
+  entries = malloc (max_cnt * sizeof *entries + 1);
+  if (entries == NULL)
+    return false;
+  cnt = 0;
+  pos = 0;
+  while (cnt < max_cnt && next_entry (dir, hashed ? &h : NULL, &pos,
+                                      &entries[cnt]))
+    if (entries[cnt].in_use)
+      cnt++;
+
+  buckets = malloc (cnt * sizeof *buckets + 1);
+  b = malloc (sizeof *b);
+  if (buckets == NULL || b == NULL)
+    goto done;
+  for (i = 0; i < cnt; i++)
+    buckets[i] = hash_string (entries[i].name) & (bucket_cnt - 1);
+
+  /* Grow DIR to its final size before overwriting any of it.
+     Only growing the file can fail, so a full disk leaves DIR as
+     it was instead of half rewritten. */
+  block_cnt = 1 + bucket_cnt;
+  for (k = 0; k < bucket_cnt; k++)
+    {
+      size_t used = 0;
+
+      for (i = 0; i < cnt; i++)
+        if (buckets[i] == k)
+          used++;
+      if (used > DIR_BLOCK_ENTRIES)
+        block_cnt += DIV_ROUND_UP (used, DIR_BLOCK_ENTRIES) - 1;
+    }
+  pos = (off_t) block_cnt * DISK_SECTOR_SIZE;
+  if (inode_length (dir->inode) < pos
+      && inode_write_at (dir->inode, "", 1, pos - 1) != 1)
+    goto done;
+
+  /* Write out each bucket's chain, overflow blocks after all the
+     first blocks. */
+  next_block = 1 + bucket_cnt;
+  for (k = 0; k < bucket_cnt; k++)
+    {
+      uint32_t block = 1 + k;
+      size_t used = 0;
+
+      memset (b, 0, sizeof *b);
+      for (i = 0; i < cnt; i++)
+        if (buckets[i] == k)
+          {
+            if (used == DIR_BLOCK_ENTRIES)
+              {
+                b->next = next_block++;
+                if (inode_write_at (dir->inode, b, sizeof *b,
+                                    (off_t) block * DISK_SECTOR_SIZE)
+                    != sizeof *b)
+                  goto done;
+                block = b->next;
+                memset (b, 0, sizeof *b);
+                used = 0;
+              }
+            b->entries[used++] = entries[i];
+          }
+      if (inode_write_at (dir->inode, b, sizeof *b,
+                          (off_t) block * DISK_SECTOR_SIZE) != sizeof *b)
+        goto done;
+    }
+
+  ASSERT (next_block == block_cnt);
+  h.magic = DIR_MAGIC;
+  h.bucket_cnt = bucket_cnt;
+  h.block_cnt = block_cnt;
+  h.entry_cnt = cnt;
+  success = inode_write_at (dir->inode, &h, sizeof h, 0) == sizeof h;
+
+ done:
+  free (b);
+  free (buckets);
+  free (entries);
+  return success;
+}
+
+/* Searches DIR for a file with the given NAME.
+   If successful, returns true, sets *EP to the directory entry
+   if EP is non-null, and sets *OFSP to the byte offset of the
+   directory entry if OFSP is non-null.
+   otherwise, returns false and ignores EP and OFSP. */
+static bool
+lookup (const struct dir *dir, const char *name,
+        struct dir_entry *ep, off_t *ofsp) 
+{
+  struct dir_header h;
+
+  ASSERT (dir != NULL);
+  ASSERT (name != NULL);
+
+  if (read_header (dir, &h))
+    return hashed_lookup (dir, &h, name, ep, ofsp, NULL, NULL);
+  else
+    return linear_lookup (dir, name, ep, ofsp, NULL);
+}
+
 /* Searches DIR for a file with the given NAME
    and returns true if one exists, false otherwise.
    On success, sets *INODE to an inode for the file, otherwise to
@@ -119,13 +405,28 @@ bool
 dir_lookup (const struct dir *dir, const char *name,
             struct inode **inode) 
 {
+  disk_sector_t dir_sector, sector;
   struct dir_entry e;
 
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
-  if (lookup (dir, name, &e, NULL))
-    *inode = inode_open (e.inode_sector);
+  /* A removed directory has no entries, not even "." and "..". */
+  *inode = NULL;
+  if (inode_is_removed (dir->inode))
+    return false;
+
+  /* Consult the dcache first, filling it in on a miss. */
+  dir_sector = inode_get_inumber (dir->inode);
+  if (!dcache_lookup (dir_sector, name, &sector))
+    {
+      sector = (lookup (dir, name, &e, NULL)
+                ? e.inode_sector : DCACHE_NEGATIVE);
+      dcache_insert (dir_sector, name, sector);
+    }
+
+  if (sector != DCACHE_NEGATIVE)
+    *inode = inode_open (sector);
   else
     *inode = NULL;
 
@@ -141,8 +442,11 @@ dir_lookup (const struct dir *dir, const char *name,
 bool
 dir_add (struct dir *dir, const char *name, disk_sector_t inode_sector) 
 {
+  static struct dir_block empty_block;
+  struct dir_header h;
   struct dir_entry e;
   off_t ofs;
+  uint32_t last;
   bool success = false;
   
   ASSERT (dir != NULL);
@@ -151,39 +455,86 @@ dir_add (struct dir *dir, const char *name, disk_sector_t inode_sector)
   /* Check NAME for validity. */
   if (*name == '\0' || strlen (name) > NAME_MAX)
     return false;
+  if (inode_is_removed (dir->inode))
+    return false;
+
+  if (!read_header (dir, &h))
+    {
+      /* Check that NAME is not in use, finding a free slot on the
+         way.  A full linear directory that is big enough is
+         converted to hashed layout instead of being extended. */
+      if (linear_lookup (dir, name, NULL, NULL, &ofs))
+        goto done;
+      if (ofs < inode_length (dir->inode)
+          || ofs / (off_t) sizeof e < DIR_LINEAR_MAX)
+        goto write;
+      if (!rehash (dir, DIR_FIRST_BUCKETS) || !read_header (dir, &h))
+        goto done;
+    }
 
-  /* Check that NAME is not in use. */
-  if (lookup (dir, name, NULL, NULL))
+  /* Keep chains about one block long by doubling the bucket count
+     whenever the average chain fills up. */
+  if (h.entry_cnt >= h.bucket_cnt * DIR_BLOCK_ENTRIES
+      && (!rehash (dir, h.bucket_cnt * 2) || !read_header (dir, &h)))
     goto done;
 
-  /* Set OFS to offset of free slot.
-     If there are no free slots, then it will be set to the
-     current end-of-file.
-     
-     inode_read_at() will only return a short read at end of file.
-     Otherwise, we'd need to verify that we didn't get a short
-     read due to something intermittent such as low memory. */
-  for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
-       ofs += sizeof e) 
-    if (!e.in_use)
-      break;
+  if (hashed_lookup (dir, &h, name, NULL, NULL, &ofs, &last)
+      || last == 0)
+    goto done;
+  if (ofs == -1)
+    {
+      /* NAME's bucket chain is full, so chain on a new block. */
+      uint32_t block = h.block_cnt++;
+      if (inode_write_at (dir->inode, &empty_block, sizeof empty_block,
+                          (off_t) block * DISK_SECTOR_SIZE)
+          != sizeof empty_block
+          || inode_write_at (dir->inode, &block, sizeof block,
+                             (off_t) last * DISK_SECTOR_SIZE)
+             != sizeof block)
+        goto done;
+      ofs = entry_ofs (block, 0);
+    }
+  h.entry_cnt++;
+  if (inode_write_at (dir->inode, &h, sizeof h, 0) != sizeof h)
+    goto done;
 
+ write:
   /* Write slot. */
   e.in_use = true;
   strlcpy (e.name, name, sizeof e.name);
   e.inode_sector = inode_sector;
   success = inode_write_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
+  if (success)
+    dcache_insert (inode_get_inumber (dir->inode), name, inode_sector);
 
  done:
   return success;
 }
 
+/* Returns true if DIR has no entries besides "." and "..". */
+static bool
+dir_is_empty (const struct dir *dir)
+{
+  struct dir_header h;
+  struct dir_entry e;
+  bool hashed = read_header (dir, &h);
+  off_t pos = 0;
+
+  while (next_entry (dir, hashed ? &h : NULL, &pos, &e))
+    if (e.in_use && strcmp (e.name, ".") && strcmp (e.name, ".."))
+      return false;
+  return true;
+}
+
 /* Removes any entry for NAME in DIR.
-   Returns true if successful, false on failure,
-   which occurs only if there is no file with the given NAME. */
+   Returns true if successful, false on failure, which occurs
+   only if there is no file with the given NAME, NAME is "." or
+   "..", or NAME is a directory that is not empty.  An empty
+   directory may be removed even while it is open. */
 bool
 dir_remove (struct dir *dir, const char *name) 
 {
+  struct dir_header h;
   struct dir_entry e;
   struct inode *inode = NULL;
   bool success = false;
@@ -193,7 +544,8 @@ dir_remove (struct dir *dir, const char *name)
   ASSERT (name != NULL);
 
   /* Find directory entry. */
-  if (!lookup (dir, name, &e, &ofs))
+  if (!strcmp (name, ".") || !strcmp (name, "..")
+      || !lookup (dir, name, &e, &ofs))
     goto done;
 
   /* Open inode. */
@@ -201,13 +553,33 @@ dir_remove (struct dir *dir, const char *name)
   if (inode == NULL)
     goto done;
 
+  /* Refuse to remove a directory that still has entries. */
+  if (inode_is_dir (inode))
+    {
+      struct dir *victim = dir_open (inode_reopen (inode));
+      bool empty = victim != NULL && dir_is_empty (victim);
+      dir_close (victim);
+      if (!empty)
+        goto done;
+    }
+
   /* Erase directory entry. */
   e.in_use = false;
   if (inode_write_at (dir->inode, &e, sizeof e, ofs) != sizeof e) 
     goto done;
+  if (read_header (dir, &h))
+    {
+      h.entry_cnt--;
+      if (inode_write_at (dir->inode, &h, sizeof h, 0) != sizeof h)
+        goto done;
+    }
 
-  /* Remove inode. */
+  /* Remove inode.  Its sector may be reused by a new directory,
+     so forget what was cached about its entries. */
   inode_remove (inode);
+  if (inode_is_dir (inode))
+    dcache_purge (e.inode_sector);
+  dcache_insert (inode_get_inumber (dir->inode), name, DCACHE_NEGATIVE);
   success = true;
 
  done:
@@ -215,18 +587,19 @@ dir_remove (struct dir *dir, const char *name)
   return success;
 }
 
-/* Reads the next directory entry in DIR and stores the name in
-   NAME.  Returns true if successful, false if the directory
-   contains no more entries. */
+/* Reads the next directory entry in DIR, other than "." and "..",
+   and stores the name in NAME.  Returns true if successful, false
+   if the directory contains no more entries. */
 bool
 dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
 {
+  struct dir_header h;
   struct dir_entry e;
+  bool hashed = read_header (dir, &h);
 
-  while (inode_read_at (dir->inode, &e, sizeof e, dir->pos) == sizeof e) 
+  while (next_entry (dir, hashed ? &h : NULL, &dir->pos, &e)) 
     {
-      dir->pos += sizeof e;
-      if (e.in_use)
+      if (e.in_use && strcmp (e.name, ".") && strcmp (e.name, ".."))
         {
           strlcpy (name, e.name, NAME_MAX + 1);
           return true;
@@ -234,3 +607,30 @@ dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
     }
   return false;
 }
+
+/* Reads up to MAX_CNT of the next entries in DIR, other than "."
+   and "..", into ENTRIES and returns the number read, which is 0
+   at the end of the directory.  The header is read once for the
+   whole batch rather than once per entry. */
+size_t
+dir_readdir_batch (struct dir *dir, struct readdir_entry *entries,
+                   size_t max_cnt)
+{
+  struct dir_header h;
+  struct dir_entry e;
+  bool hashed = read_header (dir, &h);
+  size_t cnt = 0;
+
+  while (cnt < max_cnt && next_entry (dir, hashed ? &h : NULL, &dir->pos, &e))
+    if (e.in_use && strcmp (e.name, ".") && strcmp (e.name, ".."))
+      {
+        struct readdir_entry *r = &entries[cnt++];
+        struct inode *inode = inode_open (e.inode_sector);
+
+        r->inumber = e.inode_sector;
+        r->is_dir = inode != NULL && inode_is_dir (inode);
+        strlcpy (r->name, e.name, sizeof r->name);
+        inode_close (inode);
+      }
+  return cnt;
+}
@@ -3,18 +3,21 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <syscall-nr.h>
 #include "devices/disk.h"
 
 /* Maximum length of a file name component.
    This is the traditional UNIX maximum length.
    After directories are implemented, this maximum length may be
-   retained, but much longer full path names must be allowed. */
-#define NAME_MAX 14
+   retained, but much longer full path names must be allowed.
+   User programs see it as FILE_NAME_MAX. */
+#define NAME_MAX FILE_NAME_MAX
 
 struct inode;
 
 /* Opening and closing directories. */
-bool dir_create (disk_sector_t sector, size_t entry_cnt);
+bool dir_create (disk_sector_t sector, size_t entry_cnt,
+                 disk_sector_t parent_sector);
 struct dir *dir_open (struct inode *);
 struct dir *dir_open_root (void);
 struct dir *dir_reopen (struct dir *);
@@ -26,5 +29,7 @@ bool dir_lookup (const struct dir *, const char *name, struct inode **);
 bool dir_add (struct dir *, const char *name, disk_sector_t);
 bool dir_remove (struct dir *, const char *name);
 bool dir_readdir (struct dir *, char name[NAME_MAX + 1]);
+size_t dir_readdir_batch (struct dir *, struct readdir_entry *,
+                          size_t max_cnt);
 
 #endif /* filesys/directory.h */
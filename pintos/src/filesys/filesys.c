@@ -2,11 +2,15 @@
 #include <debug.h>
 #include <stdio.h>
 #include <string.h>
+#include "filesys/dcache.h"
 #include "filesys/file.h"
 #include "filesys/free-map.h"
 #include "filesys/inode.h"
 #include "filesys/directory.h"
 #include "devices/disk.h"
+#ifdef USERPROG
+#include "userprog/process.h"
+#endif
 
 /* The disk that contains the file system. */
 struct disk *filesys_disk;
@@ -23,6 +27,7 @@ filesys_init (bool format)
     PANIC ("hd0:1 (hdb) not present, file system initialization failed");
 
   inode_init ();
+  dcache_init ();
   free_map_init ();
 
   if (format) 
@@ -36,19 +41,84 @@ filesys_init (bool format)
 void
 filesys_done (void) 
 {
-  /*
-  struct list_elem *e;
-  struct cache_entry *c;
-  while(!list_empty(&cache_list)){
-    c = list_entry(list_pop_front(&cache_list), struct cache_entry, elem);
-    disk_write(filesys_disk, c->sector_idx, c->data);
-    free(c);
-  }
-  */
-
   free_map_close ();
+  inode_flush_all ();
 }
 
+/* Opens the directory that relative paths start from: the
+   current process's working directory, or the root directory if
+   there is none. */
+static struct dir *
+open_cwd (void)
+{
+#ifdef USERPROG
+  struct inode *cwd = process_get_cwd ();
+  if (cwd != NULL)
+    return dir_open (inode_reopen (cwd));
+#endif
+  return dir_open_root ();
+}
+
+/* Walks PATH up to its last component, starting from the root
+   directory if PATH begins with "/" and from the working
+   directory otherwise.  Each step goes through dir_lookup(), so
+   repeated walks are served from the dcache.
+   On success returns the directory that should contain the last
+   component, which the caller must close, and copies the
+   component into NAME.  A path with no components, such as "/",
+   names the starting directory itself, so NAME is set to ".".
+   Returns a null pointer if PATH is empty, a component is too
+   long, or a directory along the way does not exist. */
+static struct dir *
+resolve_path (const char *path, char name[NAME_MAX + 1])
+{
+  struct dir *dir;
+
+  if (*path == '\0')
+    return NULL;
+  dir = *path == '/' ? dir_open_root () : open_cwd ();
+  strlcpy (name, ".", NAME_MAX + 1);
+
+  while (dir != NULL)
+    {
+      struct inode *inode;
+      size_t len;
+
+      while (*path == '/')
+        path++;
+      if (*path == '\0')
+        break;
+
+      /* Copy out the next component. */
+      len = strcspn (path, "/");
+      if (len > NAME_MAX)
+        {
+          dir_close (dir);
+          return NULL;
+        }
+      memcpy (name, path, len);
+      name[len] = '\0';
+      path += len;
+
+      /* Stop at the last component. */
+      while (*path == '/')
+        path++;
+      if (*path == '\0')
+        break;
+
+      /* Descend into the directory it names. */
+      dir_lookup (dir, name, &inode);
+      dir_close (dir);
+      if (inode != NULL && !inode_is_dir (inode))
+        {
+          inode_close (inode);
+          inode = NULL;
+        }
+      dir = dir_open (inode);
+    }
+  return dir;
+}
+
 /* Creates a file named NAME with the given INITIAL_SIZE.
    Returns true if successful, false otherwise.
    Fails if a file named NAME already exists,
@@ -56,12 +126,13 @@ filesys_done (void)
 bool
 filesys_create (const char *name, off_t initial_size) 
 {
+  char base[NAME_MAX + 1];
   disk_sector_t inode_sector = 0;
-  struct dir *dir = dir_open_root ();
+  struct dir *dir = resolve_path (name, base);
   bool success = (dir != NULL
                   && free_map_allocate (1, &inode_sector)
-                  && inode_create (inode_sector, initial_size)
-                  && dir_add (dir, name, inode_sector));
+                  && inode_create (inode_sector, initial_size, false)
+                  && dir_add (dir, base, inode_sector));
   if (!success && inode_sector != 0) 
     free_map_release (inode_sector, 1);
   dir_close (dir);
@@ -69,7 +140,30 @@ filesys_create (const char *name, off_t initial_size)
   return success;
 }
 
-/* Opens the file with the given NAME.
+/* Creates a directory named NAME.
+   Returns true if successful, false otherwise.
+   Fails if a file named NAME already exists, if its parent
+   directory does not exist, or if internal memory allocation
+   fails. */
+bool
+filesys_mkdir (const char *name)
+{
+  char base[NAME_MAX + 1];
+  disk_sector_t inode_sector = 0;
+  struct dir *dir = resolve_path (name, base);
+  bool success = (dir != NULL
+                  && free_map_allocate (1, &inode_sector)
+                  && dir_create (inode_sector, 16,
+                                 inode_get_inumber (dir_get_inode (dir)))
+                  && dir_add (dir, base, inode_sector));
+  if (!success && inode_sector != 0) 
+    free_map_release (inode_sector, 1);
+  dir_close (dir);
+
+  return success;
+}
+
+/* Opens the file or directory with the given NAME.
    Returns the new file if successful or a null pointer
    otherwise.
    Fails if no file named NAME exists,
@@ -77,27 +171,50 @@ filesys_create (const char *name, off_t initial_size)
 struct file *
 filesys_open (const char *name)
 {
-  struct dir *dir = dir_open_root ();
+  char base[NAME_MAX + 1];
+  struct dir *dir = resolve_path (name, base);
   struct inode *inode = NULL;
 
-  if (dir != NULL){
-    dir_lookup (dir, name, &inode);
-
-  }
+  if (dir != NULL)
+    dir_lookup (dir, base, &inode);
   dir_close (dir);
 
   return file_open (inode);
 }
 
-/* Deletes the file named NAME.
+/* Opens the directory with the given NAME.
+   Returns the new directory if successful or a null pointer
+   otherwise.
+   Fails if NAME does not exist or is not a directory. */
+struct dir *
+filesys_open_dir (const char *name)
+{
+  char base[NAME_MAX + 1];
+  struct dir *dir = resolve_path (name, base);
+  struct inode *inode = NULL;
+
+  if (dir != NULL)
+    dir_lookup (dir, base, &inode);
+  dir_close (dir);
+
+  if (inode != NULL && !inode_is_dir (inode))
+    {
+      inode_close (inode);
+      inode = NULL;
+    }
+  return dir_open (inode);
+}
+
+/* Deletes the file or empty directory named NAME.
    Returns true if successful, false on failure.
    Fails if no file named NAME exists,
    or if an internal memory allocation fails. */
 bool
 filesys_remove (const char *name) 
 {
-  struct dir *dir = dir_open_root ();
-  bool success = dir != NULL && dir_remove (dir, name);
+  char base[NAME_MAX + 1];
+  struct dir *dir = resolve_path (name, base);
+  bool success = dir != NULL && dir_remove (dir, base);
   dir_close (dir); 
 
   return success;
@@ -109,7 +226,7 @@ do_format (void)
 {
   printf ("Formatting file system...");
   free_map_create ();
-  if (!dir_create (ROOT_DIR_SECTOR, 16))
+  if (!dir_create (ROOT_DIR_SECTOR, 16, ROOT_DIR_SECTOR))
     PANIC ("root directory creation failed");
   free_map_close ();
   printf ("done.\n");
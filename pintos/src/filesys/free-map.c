@@ -34,14 +34,8 @@ free_map_allocate (size_t cnt, disk_sector_t *sectorp)
       bitmap_set_multiple (free_map, sector, cnt, false); 
       sector = BITMAP_ERROR;
     }
-<<<<<<< HEAD
-  if (sector != BITMAP_ERROR){
-      *sectorp = sector;
-    }
-=======
   if (sector != BITMAP_ERROR)
     *sectorp = sector;
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
   return sector != BITMAP_ERROR;
 }
 
@@ -78,8 +72,7 @@ void
 free_map_create (void) 
 {
   /* Create inode. */
-  printf("create\n");
-  if (!inode_create (FREE_MAP_SECTOR, bitmap_file_size (free_map)))
+  if (!inode_create (FREE_MAP_SECTOR, bitmap_file_size (free_map), false))
     PANIC ("free map creation failed");
 
   /* Write bitmap to file. */
@@ -13,6 +13,9 @@
 #define INDIRECT_CNT 128
 #define DOUBLY_CNT 16384
 
+/* Maximum number of closed inodes kept in the inode cache. */
+#define INODE_CACHE_CNT 64
+
 
 struct list cache_list;
 /* On-disk inode.
@@ -25,7 +28,8 @@ struct inode_disk
     disk_sector_t doubly;
     off_t length;                       /* File size in bytes. */
     unsigned magic;                     /* Magic number. */
-    uint32_t unused[24];               /* Not used. */
+    uint32_t is_dir;                    /* Nonzero if a directory. */
+    uint32_t unused[23];               /* Not used. */
   };
 
 /* Returns the number of sectors to allocate for an inode SIZE
@@ -39,145 +43,280 @@ bytes_to_sectors (off_t size)
 /* In-memory inode. */
 struct inode 
   {
-    struct list_elem elem;              /* Element in inode list. */
+    struct list_elem elem;              /* Element in inode list or cache. */
     disk_sector_t sector;               /* Sector number of disk location. */
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
+    bool dirty;                         /* DATA not yet written to disk? */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
     struct inode_disk data;             /* Inode content. */
+
+    /* Parsed block map, read in from the index blocks on first use. */
+    disk_sector_t *indirect_map;        /* Contents of DATA.indirect. */
+    disk_sector_t *doubly_map;          /* Contents of DATA.doubly. */
+    disk_sector_t **doubly_leaves;      /* Contents of DOUBLY_MAP[i]. */
   };
 
+static void cache_discard (disk_sector_t);
+static void cache_flush (void);
+static struct cache_entry *cache_fetch (disk_sector_t, bool fill);
+
+/* Returns the contents of index block SECTOR, reading them into
+   *MAPP the first time.  Returns a null pointer if memory
+   allocation fails. */
+static disk_sector_t *
+load_map (disk_sector_t **mapp, disk_sector_t sector)
+{
+  if (*mapp == NULL)
+    {
+      *mapp = malloc (DISK_SECTOR_SIZE);
+      if (*mapp != NULL)
+        disk_read (filesys_disk, sector, *mapp);
+    }
+  return *mapp;
+}
+
+/* Makes sure block map slot *SLOTP of INODE points to a sector,
+   allocating and zeroing one if the slot is empty.  PARENT is
+   the parsed index block that holds the slot, which is written
+   through to PARENT_SECTOR, or a null pointer if the slot is in
+   INODE's on-disk inode.
+   Returns false if the disk is full. */
+static bool
+fill_slot (struct inode *inode, disk_sector_t *slotp,
+           disk_sector_t *parent, disk_sector_t parent_sector)
+{
+  static char zeros[DISK_SECTOR_SIZE];
+
+  if (*slotp != 0)
+    return true;
+  if (!free_map_allocate (1, slotp))
+    return false;
+  disk_write (filesys_disk, *slotp, zeros);
+
+  if (parent != NULL)
+    disk_write (filesys_disk, parent_sector, parent);
+  else
+    inode->dirty = true;
+  return true;
+}
+
+/* Returns the disk sector that holds sector number IDX of
+   INODE's data, or 0 if there is none.
+   If ALLOCATE is true, missing data and index blocks are
+   allocated along the way. */
+static disk_sector_t
+index_to_sector (struct inode *inode, size_t idx, bool allocate)
+{
+  struct inode_disk *d = &inode->data;
+  disk_sector_t *map, *leaf;
+
+  if (idx < DIRECT_CNT)
+    {
+      if (allocate && !fill_slot (inode, &d->direct[idx], NULL, 0))
+        return 0;
+      return d->direct[idx];
+    }
+  idx -= DIRECT_CNT;
+
+  if (idx < INDIRECT_CNT)
+    {
+      if (d->indirect == 0
+          && (!allocate || !fill_slot (inode, &d->indirect, NULL, 0)))
+        return 0;
+      map = load_map (&inode->indirect_map, d->indirect);
+      if (map == NULL
+          || (allocate && !fill_slot (inode, &map[idx], map, d->indirect)))
+        return 0;
+      return map[idx];
+    }
+  idx -= INDIRECT_CNT;
+
+  if (idx < DOUBLY_CNT)
+    {
+      size_t i = idx / INDIRECT_CNT;
+
+      if (d->doubly == 0
+          && (!allocate || !fill_slot (inode, &d->doubly, NULL, 0)))
+        return 0;
+      map = load_map (&inode->doubly_map, d->doubly);
+      if (map == NULL
+          || (map[i] == 0
+              && (!allocate || !fill_slot (inode, &map[i], map, d->doubly))))
+        return 0;
+
+      if (inode->doubly_leaves == NULL)
+        {
+          inode->doubly_leaves = calloc (INDIRECT_CNT,
+                                         sizeof *inode->doubly_leaves);
+          if (inode->doubly_leaves == NULL)
+            return 0;
+        }
+      leaf = load_map (&inode->doubly_leaves[i], map[i]);
+      idx %= INDIRECT_CNT;
+      if (leaf == NULL
+          || (allocate && !fill_slot (inode, &leaf[idx], leaf, map[i])))
+        return 0;
+      return leaf[idx];
+    }
+
+  return 0;
+}
+
 /* Returns the disk sector that contains byte offset POS within
    INODE.
    Returns -1 if INODE does not contain data for a byte at offset
    POS. */
 static disk_sector_t
-byte_to_sector (const struct inode *inode, off_t pos) 
+byte_to_sector (struct inode *inode, off_t pos) 
 {
   ASSERT (inode != NULL);
-<<<<<<< HEAD
-\
-  if (pos < inode->data.length){
-    int index = pos / DISK_SECTOR_SIZE;
 
-    if(index < DIRECT_CNT)
-      return inode->data.direct[index];
-
-    index -= DIRECT_CNT;
-=======
+  if (pos < inode->data.length)
+    return index_to_sector (inode, pos / DISK_SECTOR_SIZE, false);
+  else
+    return -1;
+}
 
-  if (pos < inode->data.length){
-    int index = pos / DISK_SECTOR_SIZE;
+/* Extends INODE to LENGTH bytes, allocating zeroed sectors for
+   the new data.  Returns false if the disk fills up, in which
+   case INODE's length is unchanged. */
+static bool
+inode_extend (struct inode *inode, off_t length)
+{
+  size_t idx;
 
+  for (idx = bytes_to_sectors (inode->data.length);
+       idx < bytes_to_sectors (length); idx++)
+    if (index_to_sector (inode, idx, true) == 0)
+      return false;
 
-    if(index < DIRECT_CNT)
-      return inode->data.direct[index];
-    index -= (DIRECT_CNT -1);
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
+  inode->data.length = length;
+  inode->dirty = true;
+  return true;
+}
 
-    if(index < INDIRECT_CNT){
-      disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-      disk_read(filesys_disk, inode->data.indirect, buf);
-<<<<<<< HEAD
-//      printf("index - 1 : %d index : %d\n", buf[index-1], buf[index]);
-      return buf[index];
+/* Frees data sector SECTOR, if any. */
+static void
+release_sector (disk_sector_t sector)
+{
+  if (sector != 0)
+    {
+      cache_discard (sector);
+      free_map_release (sector, 1);
     }
+}
 
-    index -= DOUBLY_CNT;
-=======
-      return buf[index -1];
-    }
+/* Frees every data and index block of INODE, but not the sector
+   holding INODE itself. */
+static void
+release_blocks (struct inode *inode)
+{
+  struct inode_disk *d = &inode->data;
+  disk_sector_t *map;
+  size_t i, j;
+
+  for (i = 0; i < DIRECT_CNT; i++)
+    release_sector (d->direct[i]);
+
+  if (d->indirect != 0
+      && (map = load_map (&inode->indirect_map, d->indirect)) != NULL)
+    for (i = 0; i < INDIRECT_CNT; i++)
+      release_sector (map[i]);
+  release_sector (d->indirect);
+
+  if (d->doubly != 0
+      && (map = load_map (&inode->doubly_map, d->doubly)) != NULL)
+    for (i = 0; i < INDIRECT_CNT; i++)
+      {
+        disk_sector_t leaf[INDIRECT_CNT];
+
+        if (map[i] == 0)
+          continue;
+        disk_read (filesys_disk, map[i], leaf);
+        for (j = 0; j < INDIRECT_CNT; j++)
+          release_sector (leaf[j]);
+        release_sector (map[i]);
+      }
+  release_sector (d->doubly);
+}
 
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
-    if (index < DOUBLY_CNT)
+/* Writes INODE's on-disk inode back if it has been modified. */
+static void
+inode_writeback (struct inode *inode)
+{
+  if (inode->dirty)
     {
-      disk_sector_t buf1[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-      disk_read(filesys_disk, inode->data.doubly, buf1);
-
-      index = index/INDIRECT_CNT;
-      disk_sector_t buf2[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-<<<<<<< HEAD
-      disk_read(filesys_disk, buf1[index], buf2);       
-      return buf2[index];
-=======
-      disk_read(filesys_disk, buf1[index], buf2);
-
-      return buf2[index-1];
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
+      disk_write (filesys_disk, inode->sector, &inode->data);
+      inode->dirty = false;
     }
-    else
-      ASSERT(0);
-
-  }
-
-  else
-    return -1;
+}
 
+/* Frees INODE along with its parsed block map. */
+static void
+inode_free (struct inode *inode)
+{
+  if (inode->doubly_leaves != NULL)
+    {
+      size_t i;
+      for (i = 0; i < INDIRECT_CNT; i++)
+        free (inode->doubly_leaves[i]);
+      free (inode->doubly_leaves);
+    }
+  free (inode->doubly_map);
+  free (inode->indirect_map);
+  free (inode);
 }
 
 /* List of open inodes, so that opening a single inode twice
    returns the same `struct inode'. */
 static struct list open_inodes;
 
+/* Inodes that nobody has open any more, kept around so that
+   reopening them needs no disk access.  Most recently closed
+   first; at most INODE_CACHE_CNT entries. */
+static struct list inode_cache;
+static size_t inode_cache_cnt;
+
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
   list_init (&open_inodes);
+  list_init (&inode_cache);
   list_init (&cache_list);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
    writes the new inode to sector SECTOR on the file system
-   disk.
+   disk.  IS_DIR tells whether the inode is a directory.
    Returns true if successful.
    Returns false if memory or disk allocation fails. */
 bool
-inode_create (disk_sector_t sector, off_t length)
+inode_create (disk_sector_t sector, off_t length, bool is_dir)
 {
-  struct inode_disk *disk_inode = NULL;
-  bool success = false;
+  struct inode *inode;
+  bool success;
 
   ASSERT (length >= 0);
 
   /* If this assertion fails, the inode structure is not exactly
      one sector in size, and you should fix that. */
-  //printf("sizeof *disk_inode : %d\n", sizeof *disk_inode);
-  ASSERT (sizeof *disk_inode == DISK_SECTOR_SIZE);
-
-  disk_inode = calloc (1, sizeof *disk_inode);
-  if (disk_inode != NULL)
-    {
-      size_t sectors = bytes_to_sectors (length);
-      disk_inode->length = length;
-      disk_inode->magic = INODE_MAGIC;
-      if (sector_allocate(sectors, disk_inode))
-      {
-        //printf("success\n");
-        success = true;
-        disk_write (filesys_disk, sector, disk_inode);
-
-      }
+  ASSERT (sizeof inode->data == DISK_SECTOR_SIZE);
 
+  inode = calloc (1, sizeof *inode);
+  if (inode == NULL)
+    return false;
+  inode->sector = sector;
+  inode->data.magic = INODE_MAGIC;
+  inode->data.is_dir = is_dir;
 
-      /*
-      if (free_map_allocate (sectors, &disk_inode->start))
-        {
-          disk_write (filesys_disk, sector, disk_inode);
-          if (sectors > 0) 
-            {
-              static char zeros[DISK_SECTOR_SIZE];
-              size_t i;
-              
-              for (i = 0; i < sectors; i++) 
-                disk_write (filesys_disk, disk_inode->start + i, zeros); 
-            }
-          success = true; 
-        } 
-
-        */
-      free (disk_inode);
-    }
+  success = inode_extend (inode, length);
+  if (success)
+    disk_write (filesys_disk, sector, &inode->data);
+  else
+    release_blocks (inode);
+  inode_free (inode);
   return success;
 }
 
@@ -202,8 +341,23 @@ inode_open (disk_sector_t sector)
         }
     }
 
+  /* Check whether it was closed recently enough to be cached. */
+  for (e = list_begin (&inode_cache); e != list_end (&inode_cache);
+       e = list_next (e)) 
+    {
+      inode = list_entry (e, struct inode, elem);
+      if (inode->sector == sector) 
+        {
+          list_remove (&inode->elem);
+          inode_cache_cnt--;
+          list_push_front (&open_inodes, &inode->elem);
+          inode->open_cnt = 1;
+          return inode; 
+        }
+    }
+
   /* Allocate memory. */
-  inode = malloc (sizeof *inode);
+  inode = calloc (1, sizeof *inode);
   if (inode == NULL)
     return NULL;
 
@@ -213,6 +367,7 @@ inode_open (disk_sector_t sector)
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
+  inode->dirty = false;
   disk_read (filesys_disk, inode->sector, &inode->data);
   return inode;
 }
@@ -221,14 +376,9 @@ inode_open (disk_sector_t sector)
 struct inode *
 inode_reopen (struct inode *inode)
 {
-<<<<<<< HEAD
   if (inode != NULL){
       inode->open_cnt++;
   }
-=======
-  if (inode != NULL)
-    inode->open_cnt++;
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
   return inode;
 }
 
@@ -239,9 +389,11 @@ inode_get_inumber (const struct inode *inode)
   return inode->sector;
 }
 
-/* Closes INODE and writes it to disk.
-   If this was the last reference to INODE, frees its memory.
-   If INODE was also a removed inode, frees its blocks. */
+/* Closes INODE.
+   If this was the last reference to INODE, moves it to the inode
+   cache, evicting the least recently closed inode if the cache
+   is full.  If INODE was also a removed inode, frees its blocks
+   and memory instead. */
 void
 inode_close (struct inode *inode) 
 {
@@ -252,126 +404,46 @@ inode_close (struct inode *inode)
   /* Release resources if this was the last opener. */
   if (--inode->open_cnt == 0)
     {
-      /* Remove from inode list and release lock. */
+      /* Remove from inode list. */
       list_remove (&inode->elem);
-<<<<<<< HEAD
-      size_t index = bytes_to_sectors(inode->data.length);
-      
-=======
  
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
       /* Deallocate blocks if removed. */
       if (inode->removed) 
         {
+          release_blocks (inode);
           free_map_release (inode->sector, 1);
-          int i;
-<<<<<<< HEAD
-          for (i =0; i< min(index, DIRECT_CNT); i++){
-            free_map_release(inode->data.direct[i], 1);
-           
-=======
-          size_t index = bytes_to_sectors(inode->data.length);
-          for (i =0; i< min(index, DIRECT_CNT); i++){
-            free_map_release(inode->data.direct[i], 1);
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
-          }
-
-          index -= min(index, DIRECT_CNT);
-          if (index > 0)
-          {
-<<<<<<< HEAD
-            indirect_release_temp(index, inode->data.indirect);
-=======
-            indirect_release(index, inode->data.indirect);
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
-          }
-
-          index -= min(index, INDIRECT_CNT);
-          if (index > 0)
-          {
-            disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-            disk_read(filesys_disk, inode->data.doubly, buf);
-            int i;
-            for (i =0; i < min((index/INDIRECT_CNT +1), INDIRECT_CNT); i++)
-            {
-<<<<<<< HEAD
-              indirect_release_temp(index-(i*INDIRECT_CNT), buf[i]);
-
-=======
-              free_map_release(buf[i], 1);
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
-              
-            }
-          }
-          
-          //free_map_release (inode->data.start,
-                            //bytes_to_sectors (inode->data.length)); 
+          inode_free (inode);
+          return;
         }
-<<<<<<< HEAD
-      int i;
-      for (i =0; i< min(index, DIRECT_CNT); i++){
-        struct cache_entry * ce = is_hit(inode->data.direct[i]);
-        if (ce != NULL)
-          disk_write(filesys_disk, ce->sector_idx, ce->data);
-      }
-
-      index -= min(index, DIRECT_CNT);
-      if (index > 0)
-      {
-        indirect_release(index, inode->data.indirect);
-      }
 
-      index -= min(index, INDIRECT_CNT);
-      if (index > 0)
-      {
-        disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-        disk_read(filesys_disk, inode->data.doubly, buf);
-        int i;
-        for (i =0; i < min((index/INDIRECT_CNT +1), INDIRECT_CNT); i++)
+      list_push_front (&inode_cache, &inode->elem);
+      if (++inode_cache_cnt > INODE_CACHE_CNT)
         {
-          indirect_release(index-(i*INDIRECT_CNT), buf[i]);
-
-          
+          struct inode *victim = list_entry (list_pop_back (&inode_cache),
+                                             struct inode, elem);
+          inode_cache_cnt--;
+          inode_writeback (victim);
+          inode_free (victim);
         }
-      }
-=======
-
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
-      free (inode); 
     }
 }
 
+/* Writes every modified inode, open or cached, and every dirty
+   cached sector back to disk. */
 void
-indirect_release(size_t index, disk_sector_t indirect)
+inode_flush_all (void)
 {
-  disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-  disk_read(filesys_disk, indirect, buf);
-  int i;
-  for (i =0; i < min(index, INDIRECT_CNT); i++)
-  {
-<<<<<<< HEAD
-    struct cache_entry * ce = is_hit(buf[i]);
-    if (ce != NULL)
-      disk_write(filesys_disk, ce->sector_idx, ce->data);
+  struct list_elem *e;
 
-  }
+  for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
+       e = list_next (e))
+    inode_writeback (list_entry (e, struct inode, elem));
+  for (e = list_begin (&inode_cache); e != list_end (&inode_cache);
+       e = list_next (e))
+    inode_writeback (list_entry (e, struct inode, elem));
+  cache_flush ();
 }
 
-void
-indirect_release_temp(size_t index, disk_sector_t indirect)
-{
-  disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-  disk_read(filesys_disk, indirect, buf);
-  int i;
-  for (i =0; i < min(index, INDIRECT_CNT); i++)
-  {
-    free_map_release(buf[i], 1);
-
-=======
-    free_map_release(buf[i], 1);
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
-  }
-}
 /* Marks INODE to be deleted when it is closed by the last caller who
    has it open. */
 void
@@ -381,6 +453,28 @@ inode_remove (struct inode *inode)
   inode->removed = true;
 }
 
+/* Returns true if INODE has been removed. */
+bool
+inode_is_removed (const struct inode *inode)
+{
+  return inode->removed;
+}
+
+/* Returns true if writes to INODE are denied, as they are while
+   it is a running executable. */
+bool
+inode_is_write_denied (const struct inode *inode)
+{
+  return inode->deny_write_cnt > 0;
+}
+
+/* Returns true if INODE is a directory. */
+bool
+inode_is_dir (const struct inode *inode)
+{
+  return inode->data.is_dir != 0;
+}
+
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
    Returns the number of bytes actually read, which may be less
    than SIZE if an error occurs or end of file is reached. */
@@ -434,8 +528,6 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
           c = new_entry();
           //c = malloc(sizeof *c);
           c -> sector_idx = sector_idx;
-          c -> data = malloc (DISK_SECTOR_SIZE);
-          ASSERT(c->data != NULL);
   
           disk_read (filesys_disk, sector_idx, c->data);
 
@@ -461,8 +553,6 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
           c = new_entry();
           //c = malloc(sizeof *c);
           c -> sector_idx = sector_idx;
-          c -> data = malloc (DISK_SECTOR_SIZE);
-          ASSERT(c->data != NULL);
           disk_read (filesys_disk, sector_idx, c->data);
           list_push_back(&cache_list, &c->elem);
           /*
@@ -489,8 +579,7 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
 /* Writes SIZE bytes from BUFFER into INODE, starting at OFFSET.
    Returns the number of bytes actually written, which may be
    less than SIZE if end of file is reached or an error occurs.
-   (Normally a write at end of file would extend the inode, but
-   growth is not yet implemented.) */
+   A write past end of file extends the inode. */
 off_t
 inode_write_at (struct inode *inode, const void *buffer_, off_t size,
                 off_t offset) 
@@ -499,112 +588,42 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   off_t bytes_written = 0;
   uint8_t *bounce = NULL;
 
-<<<<<<< HEAD
   ASSERT(inode != NULL);
   if (inode->deny_write_cnt)
     return 0;
-//  printf("length : %d", inode->data.length);
-
-  if (offset + size > inode->data.length){
-    int temp_sectors = bytes_to_sectors(inode->data.length);
-    int last_sectors = bytes_to_sectors(offset + size);
-    int cnt = last_sectors - temp_sectors;
-
-//  printf("TEMP SECTOR : %d\n", temp_sectors);
-
-//  printf("LAST SECTOR : %d\n", last_sectors);
-
-
-  if(temp_sectors < DIRECT_CNT){
-    direct_allocate(temp_sectors+1, min(cnt, DIRECT_CNT-temp_sectors), &inode->data);
-    
-    //현재까지 alloacte한 결과 update
-    cnt -= min(cnt, DIRECT_CNT-temp_sectors);
-    temp_sectors = min(temp_sectors + cnt, DIRECT_CNT);
-  }
-
-  if(DIRECT_CNT <= temp_sectors && temp_sectors < DIRECT_CNT + INDIRECT_CNT){
-    temp_sectors = temp_sectors - DIRECT_CNT;
-    if(inode->data.indirect == 0)
-      if (!free_map_allocate (1, &inode->data.indirect))
-        ASSERT(0);
-
-    indirect_allocate(temp_sectors + 1, min(cnt, INDIRECT_CNT-temp_sectors), inode->data.indirect);
-
-    cnt -= min(cnt, INDIRECT_CNT-temp_sectors);
-    temp_sectors = min(temp_sectors + cnt, INDIRECT_CNT);
-  }
-  if(INDIRECT_CNT <= temp_sectors && temp_sectors < INDIRECT_CNT + DOUBLY_CNT){
-    temp_sectors = temp_sectors - INDIRECT_CNT;
-
-    if(inode->data.doubly == 0)
-      if (!free_map_allocate (1, &inode->data.doubly))
-        ASSERT(0);
-
-    doubly_allocate(temp_sectors + 1, min(cnt, DOUBLY_CNT-temp_sectors), inode->data.doubly);
-
-    cnt -= min(cnt, DOUBLY_CNT-temp_sectors);
-    temp_sectors = min(temp_sectors + cnt, INDIRECT_CNT);
-  }
-  if(cnt > 0)
-    ASSERT(0);
-  inode->data.length = offset + size; 
-//  printf("WRITE : %d\n", offset + size); 
-  disk_write(filesys_disk, inode->sector, &inode->data);
-  }
-
-=======
-  if (inode->deny_write_cnt)
+  /* Grow the file first if the write runs past end of file. */
+  if (offset + size > inode->data.length
+      && !inode_extend (inode, offset + size))
     return 0;
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
 
   while (size > 0) 
     {
       /* Sector to write, starting byte offset within sector. */
       disk_sector_t sector_idx = byte_to_sector (inode, offset);
-<<<<<<< HEAD
       ASSERT(sector_idx != -1);
       int sector_ofs = offset % DISK_SECTOR_SIZE;
-=======
-      int sector_ofs = offset % DISK_SECTOR_SIZE;
-
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
       /* Bytes left in inode, bytes left in sector, lesser of the two. */
       off_t inode_left = inode_length (inode) - offset;
       int sector_left = DISK_SECTOR_SIZE - sector_ofs;
       int min_left = inode_left < sector_left ? inode_left : sector_left;
-<<<<<<< HEAD
       
-=======
-
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
       /* Number of bytes to actually write into this sector. */
       int chunk_size = size < min_left ? size : min_left;
       if (chunk_size <= 0)
         break;
 
-<<<<<<< HEAD
       
       struct cache_entry *c = is_hit(sector_idx);
       struct cache_entry *next_c;
       if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE) 
         {
 
-=======
-      struct cache_entry *c = is_hit(sector_idx);
-      struct cache_entry *next_c;
-
-      if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE) 
-        {
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
           /* Write full sector directly to disk. */
           if(c == NULL){
             //FETCH, LIST 추가, MEMCPY
             c = new_entry();
             //c = malloc(sizeof *c);
             c -> sector_idx = sector_idx;
-            c -> data = malloc (DISK_SECTOR_SIZE);
-            ASSERT(c->data != NULL);
             disk_read (filesys_disk, sector_idx, c->data);
             list_push_back(&cache_list, &c->elem);
             /*
@@ -614,21 +633,15 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
           disk_read (filesys_disk, sector_idx+1, next_c->data);
           list_push_back(&cache_list, &next_c->elem);
           */
-<<<<<<< HEAD
           //ASSERT(0);
-=======
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
           }
           memcpy (c->data, buffer + bytes_written, chunk_size); 
+          c->dirty = true;
         }
       else 
         {
           /* We need a bounce buffer. */
-<<<<<<< HEAD
 
-=======
-         
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
           /* If the sector contains data before or after the chunk
              we're writing, then we need to read in the sector
              first.  Otherwise we start with a sector of all zeros. */
@@ -637,8 +650,6 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
             c = new_entry();
            // c = malloc(sizeof *c);
             c -> sector_idx = sector_idx;
-            c -> data = malloc (DISK_SECTOR_SIZE);
-            ASSERT(c->data != NULL);
             if (sector_ofs > 0 || chunk_size < sector_left) 
             disk_read (filesys_disk, sector_idx, c->data);
             else
@@ -653,11 +664,8 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
           list_push_back(&cache_list, &next_c->elem);
           */
           }
-<<<<<<< HEAD
-=======
-
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
           memcpy (c->data + sector_ofs, buffer + bytes_written, chunk_size);
+          c->dirty = true;
         }
 
       /* Advance. */
@@ -670,99 +678,62 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   return bytes_written;
 }
 
-bool
-sector_allocate(size_t sectors, struct inode_disk * disk_inode)
-{
-
-  int i;
-  for (i =0; i<min(sectors, DIRECT_CNT); i++){
-    if(disk_inode->direct[i] == 0)
-    {
-      if (!free_map_allocate (1, &disk_inode->direct[i])){
-        ASSERT(0);
-        return false;
-      }
-      static char zeros[DISK_SECTOR_SIZE];
-      disk_write (filesys_disk, disk_inode->direct[i], zeros); 
-    }
-  }
-  sectors -= min(sectors, DIRECT_CNT);
-  //printf("sectors : %d\n",sectors);
-  if (sectors ==0)
-    return true;
-
-  if(!free_map_allocate(1, &disk_inode->indirect))
-    return false;
-  inode_indirect(min(sectors, INDIRECT_CNT), disk_inode->indirect);
-  sectors -= min(sectors, INDIRECT_CNT);
-
- if (sectors ==0)
-    return true;
-
-
-  if(!free_map_allocate(1, &disk_inode->doubly))
-    return false;
-  inode_doubly(min(sectors, INDIRECT_CNT), disk_inode);
-
-
-
-
-  if (sectors ==0)
-    return true;
-
-
-
-}
-
-
-bool
-inode_indirect(size_t sectors, disk_sector_t indirect)
+/* Copies SIZE bytes of SRC, starting at SRC_OFS, into DST,
+   starting at DST_OFS, moving data directly from SRC's cached
+   sectors to DST's without a bounce buffer.  Stops early at the
+   end of SRC.  A copy past the end of DST extends it.  The two
+   ranges must not overlap if SRC and DST are the same inode.
+   Returns the number of bytes copied. */
+off_t
+inode_copy (struct inode *dst, off_t dst_ofs,
+            struct inode *src, off_t src_ofs, off_t size)
 {
-  disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-  //memset(&buf, 0, DISK_SECTOR_SIZE);
-  int i;
-  for(i = 0; i < sectors; i++)
-  {
-
-    if (!free_map_allocate (1, &buf[i])){
-      return false;
-    }
-
-
-    static char zeros[DISK_SECTOR_SIZE];
-    disk_write (filesys_disk, buf[i], zeros); 
-
-  }
-  disk_write(filesys_disk, indirect, buf);
-  return true;
+  off_t bytes_copied = 0;
 
-}
-
-
-bool 
-inode_doubly(size_t sectors, struct inode_disk * disk_inode)
-{
-  disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-  int i = 0;
-  while (sectors >0)
-  {
+  ASSERT (dst != NULL && src != NULL);
+  if (dst->deny_write_cnt || src_ofs >= inode_length (src))
+    return 0;
+  if (size > inode_length (src) - src_ofs)
+    size = inode_length (src) - src_ofs;
+  if (dst_ofs + size > dst->data.length
+      && !inode_extend (dst, dst_ofs + size))
+    return 0;
 
-    if (!free_map_allocate (1, &buf[i])){
+  while (size > 0)
+    {
+      int src_sector_ofs = src_ofs % DISK_SECTOR_SIZE;
+      int dst_sector_ofs = dst_ofs % DISK_SECTOR_SIZE;
+      int chunk_size = DISK_SECTOR_SIZE - (src_sector_ofs > dst_sector_ofs
+                                           ? src_sector_ofs : dst_sector_ofs);
+      struct cache_entry *src_c, *dst_c;
+
+      if (chunk_size > size)
+        chunk_size = size;
+
+      /* Fetch the source sector and move it to the back of the
+         FIFO so that fetching the destination cannot evict it. */
+      src_c = cache_fetch (byte_to_sector (src, src_ofs), true);
+      list_remove (&src_c->elem);
+      list_push_back (&cache_list, &src_c->elem);
+
+      /* A destination sector that is overwritten whole need not
+         be read first. */
+      dst_c = cache_fetch (byte_to_sector (dst, dst_ofs),
+                           chunk_size < DISK_SECTOR_SIZE);
+      memmove (dst_c->data + dst_sector_ofs, src_c->data + src_sector_ofs,
+               chunk_size);
+      dst_c->dirty = true;
 
-      return false;
+      /* Advance. */
+      size -= chunk_size;
+      src_ofs += chunk_size;
+      dst_ofs += chunk_size;
+      bytes_copied += chunk_size;
     }
 
-    inode_indirect(min(sectors, INDIRECT_CNT), buf[i]);
-    sectors -= min(sectors, INDIRECT_CNT);
-
-    i++; 
-  }
-  disk_write(filesys_disk, disk_inode->doubly, buf);
-  return true;
-
+  return bytes_copied;
 }
 
-
 /* Disables writes to INODE.
    May be called at most once per inode opener. */
 void
@@ -809,120 +780,76 @@ struct cache_entry *
 new_entry(void){
   struct cache_entry * c;
   if(list_size(&cache_list) >= 64){
+    /* Reuse the oldest entry and its data buffer. */
     c = list_entry(list_pop_front(&cache_list), struct cache_entry, elem);
-    disk_write(filesys_disk, c->sector_idx, c->data);
-    //ASSERT(0);
+    if (c->dirty)
+      disk_write(filesys_disk, c->sector_idx, c->data);
   }
   else{
     c = malloc(sizeof *c);
+    ASSERT(c != NULL);
+    c->data = malloc (DISK_SECTOR_SIZE);
+    ASSERT(c->data != NULL);
   }
+  c->dirty = false;
 
   return c;
 
 }
 
-int
-min(int a, int b){
-  if(a < b)
-    return a;
-  else
-    return b;
-}
-<<<<<<< HEAD
-
-
-
-
-
-bool
-direct_allocate(int start_sector, int cnt, struct inode_disk * disk_inode)
+/* Returns the cache entry for SECTOR, bringing it into the cache
+   if it is not there.  A newly cached sector is read from disk if
+   FILL is true and left with stale contents otherwise. */
+static struct cache_entry *
+cache_fetch (disk_sector_t sector, bool fill)
 {
-  int i;
-  for (i = 0; i < cnt; i++){
-    if(disk_inode->direct[i+start_sector-1] == 0)
+  struct cache_entry *c = is_hit (sector);
+  if (c == NULL)
     {
-      if (!free_map_allocate (1, &disk_inode->direct[i+start_sector-1])){
-        ASSERT(0);
-        return false;
-      }
-      static char zeros[DISK_SECTOR_SIZE];
-      disk_write (filesys_disk, disk_inode->direct[i+start_sector-1], zeros); 
+      c = new_entry ();
+      c->sector_idx = sector;
+      if (fill)
+        disk_read (filesys_disk, sector, c->data);
+      list_push_back (&cache_list, &c->elem);
     }
-  }
-
-  return true;
+  return c;
 }
 
-
-
-
-bool
-indirect_allocate(int start_sector, int cnt, disk_sector_t indirect)
+/* Drops any cached copy of SECTOR without writing it back,
+   because the sector has been freed. */
+static void
+cache_discard (disk_sector_t sector)
 {
-  disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-  //memset(&buf, 0, DISK_SECTOR_SIZE);
-
-  
-  disk_read(filesys_disk, indirect, buf);
-
-  int i;
-  for(i = 0; i < cnt; i++)
-  {
-    if (!free_map_allocate (1, &buf[i+start_sector-1])){
-      return false;
+  struct cache_entry *c = is_hit (sector);
+  if (c != NULL)
+    {
+      list_remove (&c->elem);
+      free (c->data);
+      free (c);
     }
-    static char zeros[DISK_SECTOR_SIZE];
-
-
-
-    disk_write (filesys_disk, buf[i+start_sector-1], zeros); 
-
-  }
-  disk_write(filesys_disk, indirect, buf);
-
-/*
-  if(last_sector > INDIRECT_CNT){
-    indirect_allocate(1, last_sector-INDIRECT_CNT, disk_inode->doubly);
-  }
-*/
-  return true;
-
-
-
 }
 
-bool
-doubly_allocate(int start_sector, int cnt, disk_sector_t doubly)
+/* Writes every dirty cached sector back to disk. */
+static void
+cache_flush (void)
 {
-  
-
-  disk_sector_t buf[DISK_SECTOR_SIZE/sizeof(disk_sector_t)];
-  int i = 0;
-  int index;
-
-  disk_read(filesys_disk, doubly, buf);
-
-  if(start_sector % INDIRECT_CNT != 1)
-  {
-    indirect_allocate(start_sector % INDIRECT_CNT, min(cnt, INDIRECT_CNT-(start_sector%INDIRECT_CNT)), buf[start_sector/INDIRECT_CNT]);
-    cnt -= min(cnt, INDIRECT_CNT-(start_sector%INDIRECT_CNT));
-    index = start_sector/INDIRECT_CNT + 1;
-  }
-
-
-
-
-  while(cnt > 0){
-    if (!free_map_allocate (1, &buf[index]))
-      return false;
-    indirect_allocate(1, min(cnt, INDIRECT_CNT), buf[index]);
-    cnt -= INDIRECT_CNT;
-    index++;
-  }
-
-  disk_write(filesys_disk, doubly, buf);
-  return true;
+  struct list_elem *e;
+  for (e = list_begin (&cache_list); e != list_end (&cache_list);
+       e = list_next (e))
+    {
+      struct cache_entry *c = list_entry (e, struct cache_entry, elem);
+      if (c->dirty)
+        {
+          disk_write (filesys_disk, c->sector_idx, c->data);
+          c->dirty = false;
+        }
+    }
+}
 
+int
+min(int a, int b){
+  if(a < b)
+    return a;
+  else
+    return b;
 }
-=======
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
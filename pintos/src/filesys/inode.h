@@ -16,7 +16,7 @@ struct cache_entry{
     //int sector_ofs;
     disk_sector_t sector_idx;
     uint8_t *data;
-    //write_behind에 필요한 정보
+    bool dirty;                         /* Modified since read from disk? */
 };
 
 
@@ -25,38 +25,25 @@ struct cache_entry{
 
 
 void inode_init (void);
-bool inode_create (disk_sector_t, off_t);
+bool inode_create (disk_sector_t, off_t, bool is_dir);
 struct inode *inode_open (disk_sector_t);
 struct inode *inode_reopen (struct inode *);
 disk_sector_t inode_get_inumber (const struct inode *);
 void inode_close (struct inode *);
 void inode_remove (struct inode *);
+bool inode_is_removed (const struct inode *);
+bool inode_is_write_denied (const struct inode *);
+bool inode_is_dir (const struct inode *);
 off_t inode_read_at (struct inode *, void *, off_t size, off_t offset);
 off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
+off_t inode_copy (struct inode *dst, off_t dst_ofs,
+                  struct inode *src, off_t src_ofs, off_t size);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
 off_t inode_length (const struct inode *);
+void inode_flush_all (void);
 struct cache_entry * is_hit(disk_sector_t);
 struct cache_entry * new_entry(void);
-bool sector_allocate(size_t, struct inode_disk * );
 int min(int, int);
-void indirect_release(size_t , disk_sector_t );
-<<<<<<< HEAD
-void indirect_release_temp(size_t, disk_sector_t);
-bool inode_indirect(size_t , disk_sector_t);
-bool inode_doubly(size_t, struct inode_disk *);
 
-
-bool direct_allocate(int, int , struct inode_disk *);
-bool indirect_allocate(int, int, disk_sector_t);
-bool doubly_allocate(int, int, disk_sector_t);
-
-
-
-=======
-
-bool inode_indirect(size_t , disk_sector_t);
-bool inode_doubly(size_t, struct inode_disk *);
-
->>>>>>> 8bfb090a4d7031add0f02cb7cc6a27caecdbb7f3
-#endif /* filesys/inode.h */
\ No newline at end of file
+#endif /* filesys/inode.h */
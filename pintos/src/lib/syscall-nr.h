@@ -1,6 +1,9 @@
 #ifndef __LIB_SYSCALL_NR_H
 #define __LIB_SYSCALL_NR_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 /* System call numbers. */
 enum 
   {
@@ -28,7 +31,121 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_READDIR_BATCH,          /* Reads many directory entries. */
+    SYS_PREAD,                  /* Read from a file at a given offset. */
+    SYS_PWRITE,                 /* Write to a file at a given offset. */
+    SYS_READV,                  /* Read from a file into several buffers. */
+    SYS_WRITEV,                 /* Write several buffers to a file. */
+    SYS_COPY_FILE_RANGE,        /* Copy data between two files. */
+    SYS_NULL,                   /* Do nothing, for timing entry cost. */
+    SYS_RING_SETUP,             /* Register a submission/completion ring. */
+    SYS_RING_ENTER,             /* Process submitted ring entries. */
+    SYS_AIO_READ,               /* Start reading from a file. */
+    SYS_AIO_WRITE,              /* Start writing to a file. */
+    SYS_AIO_WAIT,               /* Wait for an aio request to complete. */
+    SYS_AIO_POLL,               /* Find a completed aio request. */
+    SYS_POLL,                   /* Wait for file descriptors to be ready. */
+    SYS_GETRUSAGE               /* Report the process's paging activity. */
+  };
+
+/* Maximum length of a file name component, as returned by the
+   readdir and readdir_batch system calls.  The file system takes
+   its NAME_MAX from here. */
+#define FILE_NAME_MAX 14
+
+/* A directory entry as stored by the readdir_batch system call. */
+struct readdir_entry
+  {
+    int inumber;                /* Inode number. */
+    bool is_dir;                /* Is the entry a directory? */
+    char name[FILE_NAME_MAX + 1]; /* Null-terminated name. */
+  };
+
+/* One buffer of a readv or writev system call. */
+struct iovec
+  {
+    void *iov_base;             /* Start of buffer. */
+    size_t iov_len;             /* Length of buffer in bytes. */
+  };
+
+/* Most buffers accepted by one readv or writev. */
+#define IOV_MAX 1024
+
+/* Operations that may be submitted through a ring. */
+enum ring_op
+  {
+    RING_OP_NOP,                /* Complete with result 0. */
+    RING_OP_OPEN,               /* open (addr). */
+    RING_OP_READ,               /* read (fd, addr, len), fd not 0. */
+    RING_OP_WRITE,              /* write (fd, addr, len). */
+    RING_OP_CLOSE,              /* close (fd). */
+    RING_OP_SEEK                /* seek (fd, len). */
+  };
+
+/* A request in a submission ring. */
+struct ring_sqe
+  {
+    int op;                     /* One of enum ring_op. */
+    int fd;                     /* File descriptor. */
+    void *addr;                 /* Buffer, or file name to open. */
+    unsigned len;               /* Buffer size, or position to seek to. */
+    unsigned user_data;         /* Copied to the completion. */
+  };
+
+/* A result in a completion ring. */
+struct ring_cqe
+  {
+    unsigned user_data;         /* From the request. */
+    int result;                 /* As the system call would return, or -1. */
+  };
+
+/* Number of entries in each ring. */
+#define RING_SQ_CNT 64
+#define RING_CQ_CNT 128
+
+/* Submission and completion rings shared by a process and the
+   kernel.  The process fills in sq[] and advances sq_tail; the
+   kernel consumes requests by advancing sq_head.  The kernel
+   posts results in cq[] and advances cq_tail; the process
+   consumes them by advancing cq_head.  Indexes increase freely
+   and are taken modulo the ring size.  A ring must not cross a
+   page boundary. */
+struct ring
+  {
+    unsigned sq_head, sq_tail;
+    unsigned cq_head, cq_tail;
+    struct ring_sqe sq[RING_SQ_CNT];
+    struct ring_cqe cq[RING_CQ_CNT];
+  };
+
+/* ring_setup() flag: process requests in a kernel thread. */
+#define RING_SETUP_WORKER 0x1
+
+/* A file descriptor examined by the poll system call. */
+struct pollfd
+  {
+    int fd;                     /* File descriptor. */
+    short events;               /* Conditions of interest. */
+    short revents;              /* Conditions found, set by poll. */
+  };
+
+/* Conditions for struct pollfd. */
+#define POLLIN   0x01           /* Reading would not block. */
+#define POLLOUT  0x04           /* Writing would not block. */
+#define POLLNVAL 0x20           /* Not an open file descriptor. */
+
+/* A process's paging activity, as reported by getrusage. */
+struct rusage
+  {
+    unsigned minflt;            /* Page faults served without I/O. */
+    unsigned majflt;            /* Page faults that read a file or swap. */
+    unsigned nswapin;           /* Pages read back from swap. */
+    unsigned nswapout;          /* Pages written to swap. */
+    unsigned maxrss;            /* Most pages resident at once. */
+    unsigned iowait;            /* Timer ticks spent on paging I/O. */
   };
 
 #endif /* lib/syscall-nr.h */
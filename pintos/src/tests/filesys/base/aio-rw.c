@@ -0,0 +1,45 @@
+/* Writes a file with aio_write(), reads it back with aio_read()
+   after closing the file descriptor, and collects the results
+   with aio_poll() and aio_wait().  Also checks that a request
+   past the largest file offset is refused. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[2048];
+static char block[2048];
+
+void
+test_main (void) 
+{
+  int fd, w0, w1, r;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("aio", 0), "create \"aio\"");
+  CHECK ((fd = open ("aio")) > 1, "open \"aio\"");
+
+  CHECK ((w1 = aio_write (fd, buf + 1024, 1024, 1024)) >= 0,
+         "aio_write 1024 bytes at 1024");
+  CHECK ((w0 = aio_write (fd, buf, 1024, 0)) >= 0,
+         "aio_write 1024 bytes at 0");
+  CHECK (aio_wait (w1) == 1024, "aio_wait for write at 1024");
+  CHECK (aio_wait (w0) == 1024, "aio_wait for write at 0");
+  CHECK (aio_wait (w0) == -1, "aio_wait again (must return -1)");
+  CHECK (aio_read (fd, block, sizeof block, 0x7fffffff) == -1,
+         "aio_read at 0x7fffffff (must return -1)");
+
+  CHECK ((r = aio_read (fd, block, sizeof block, 0)) >= 0,
+         "aio_read 2048 bytes at 0");
+  msg ("close \"aio\"");
+  close (fd);
+  while (aio_poll () != r)
+    continue;
+  msg ("aio_poll found read");
+  CHECK (aio_wait (r) == (int) sizeof block, "aio_wait for read");
+  compare_bytes (block, buf, sizeof block, 0, "aio");
+  CHECK (aio_poll () == -1, "aio_poll with nothing pending");
+
+  check_file ("aio", buf, sizeof buf);
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(aio-rw) begin
+(aio-rw) create "aio"
+(aio-rw) open "aio"
+(aio-rw) aio_write 1024 bytes at 1024
+(aio-rw) aio_write 1024 bytes at 0
+(aio-rw) aio_wait for write at 1024
+(aio-rw) aio_wait for write at 0
+(aio-rw) aio_wait again (must return -1)
+(aio-rw) aio_read at 0x7fffffff (must return -1)
+(aio-rw) aio_read 2048 bytes at 0
+(aio-rw) close "aio"
+(aio-rw) aio_poll found read
+(aio-rw) aio_wait for read
+(aio-rw) aio_poll with nothing pending
+(aio-rw) open "aio" for verification
+(aio-rw) verified contents of "aio"
+(aio-rw) close "aio"
+(aio-rw) end
+EOF
+pass;
@@ -0,0 +1,40 @@
+/* Copies a file with copy_file_range() in two unaligned pieces
+   and verifies the copy.  Then copies it again with a length
+   past INT_MAX, which must copy the whole file. */
+
+#include <limits.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[1000];
+
+void
+test_main (void) 
+{
+  int in_fd, out_fd;
+  size_t i;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 241;
+
+  CHECK (create ("src", 0), "create \"src\"");
+  CHECK ((in_fd = open ("src")) > 1, "open \"src\"");
+  CHECK (write (in_fd, buf, sizeof buf) == sizeof buf, "write \"src\"");
+  seek (in_fd, 0);
+  CHECK (create ("dst", 0), "create \"dst\"");
+  CHECK ((out_fd = open ("dst")) > 1, "open \"dst\"");
+
+  CHECK (copy_file_range (in_fd, out_fd, 700) == 700,
+         "copy 700 bytes");
+  CHECK (copy_file_range (in_fd, out_fd, 700) == 300,
+         "copy 700 more bytes (must return 300)");
+  CHECK (copy_file_range (in_fd, out_fd, 700) == 0,
+         "copy at end of \"src\" (must return 0)");
+  seek (in_fd, 0);
+  seek (out_fd, 0);
+  CHECK (copy_file_range (in_fd, out_fd, UINT_MAX) == sizeof buf,
+         "copy UINT_MAX bytes (must return 1000)");
+  CHECK (tell (out_fd) == sizeof buf, "tell \"dst\"");
+  check_file ("dst", buf, sizeof buf);
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(copy-file-range) begin
+(copy-file-range) create "src"
+(copy-file-range) open "src"
+(copy-file-range) write "src"
+(copy-file-range) create "dst"
+(copy-file-range) open "dst"
+(copy-file-range) copy 700 bytes
+(copy-file-range) copy 700 more bytes (must return 300)
+(copy-file-range) copy at end of "src" (must return 0)
+(copy-file-range) copy UINT_MAX bytes (must return 1000)
+(copy-file-range) tell "dst"
+(copy-file-range) open "dst" for verification
+(copy-file-range) verified contents of "dst"
+(copy-file-range) close "dst"
+(copy-file-range) end
+EOF
+pass;
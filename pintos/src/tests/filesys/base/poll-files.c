@@ -0,0 +1,40 @@
+/* Polls a file, the console, and a closed file descriptor, and
+   checks that poll() reports each as expected without
+   blocking, and that it times out when nothing is ready. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct pollfd fds[3];
+  int fd;
+
+  CHECK (create ("pollfile", 0), "create \"pollfile\"");
+  CHECK ((fd = open ("pollfile")) > 1, "open \"pollfile\"");
+
+  fds[0].fd = fd;
+  fds[0].events = POLLIN | POLLOUT;
+  fds[1].fd = 1;
+  fds[1].events = POLLIN | POLLOUT;
+  fds[2].fd = fd + 1;
+  fds[2].events = POLLIN;
+  CHECK (poll (fds, 3, -1) == 3, "poll file, console output, bad fd");
+  CHECK (fds[0].revents == (POLLIN | POLLOUT), "file is readable and writable");
+  CHECK (fds[1].revents == POLLOUT, "console is writable");
+  CHECK (fds[2].revents == POLLNVAL, "bad fd is invalid");
+
+  fds[0].events = POLLOUT;
+  CHECK (poll (fds, 1, 0) == 1, "poll file for output only");
+  CHECK (fds[0].revents == POLLOUT, "file is writable");
+
+  fds[1].fd = 1;
+  fds[1].events = POLLIN;
+  CHECK (poll (&fds[1], 1, 50) == 0, "poll console output for input times out");
+  CHECK (fds[1].revents == 0, "console output is not readable");
+
+  msg ("close \"pollfile\"");
+  close (fd);
+}
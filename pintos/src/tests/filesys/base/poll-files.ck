@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(poll-files) begin
+(poll-files) create "pollfile"
+(poll-files) open "pollfile"
+(poll-files) poll file, console output, bad fd
+(poll-files) file is readable and writable
+(poll-files) console is writable
+(poll-files) bad fd is invalid
+(poll-files) poll file for output only
+(poll-files) file is writable
+(poll-files) poll console output for input times out
+(poll-files) console output is not readable
+(poll-files) close "pollfile"
+(poll-files) end
+EOF
+pass;
@@ -0,0 +1,43 @@
+/* Writes a file out of order with pwrite(), reads parts of it
+   back with pread(), and checks that neither call moves the
+   file position or accepts an offset past the largest file
+   offset. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[512];
+
+void
+test_main (void) 
+{
+  char block[100];
+  size_t i;
+  int fd;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 251;
+
+  CHECK (create ("pio", 0), "create \"pio\"");
+  CHECK ((fd = open ("pio")) > 1, "open \"pio\"");
+  CHECK (pwrite (fd, buf + 256, 256, 256) == 256, "pwrite 256 bytes at 256");
+  CHECK (pwrite (fd, buf, 256, 0) == 256, "pwrite 256 bytes at 0");
+  CHECK (tell (fd) == 0, "tell \"pio\" after pwrite");
+
+  CHECK (pread (fd, block, sizeof block, 300) == sizeof block,
+         "pread 100 bytes at 300");
+  compare_bytes (block, buf + 300, sizeof block, 300, "pio");
+  CHECK (pread (fd, block, sizeof block, 500) == 12,
+         "pread 100 bytes at 500 (must return 12)");
+  compare_bytes (block, buf + 500, 12, 500, "pio");
+  CHECK (tell (fd) == 0, "tell \"pio\" after pread");
+  CHECK (pread (fd, block, sizeof block, 0x80000000) == -1,
+         "pread at 0x80000000 (must return -1)");
+  CHECK (pwrite (fd, block, sizeof block, 0x7fffffff) == -1,
+         "pwrite 100 bytes at 0x7fffffff (must return -1)");
+
+  check_file_handle (fd, "pio", buf, sizeof buf);
+  msg ("close \"pio\"");
+  close (fd);
+}
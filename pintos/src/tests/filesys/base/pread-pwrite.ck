@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(pread-pwrite) begin
+(pread-pwrite) create "pio"
+(pread-pwrite) open "pio"
+(pread-pwrite) pwrite 256 bytes at 256
+(pread-pwrite) pwrite 256 bytes at 0
+(pread-pwrite) tell "pio" after pwrite
+(pread-pwrite) pread 100 bytes at 300
+(pread-pwrite) pread 100 bytes at 500 (must return 12)
+(pread-pwrite) tell "pio" after pread
+(pread-pwrite) pread at 0x80000000 (must return -1)
+(pread-pwrite) pwrite 100 bytes at 0x7fffffff (must return -1)
+(pread-pwrite) verified contents of "pio"
+(pread-pwrite) close "pio"
+(pread-pwrite) end
+EOF
+pass;
@@ -0,0 +1,52 @@
+/* Writes a file from several buffers with writev(), then reads
+   it back into differently sized buffers with readv().  Also
+   checks that buffers totalling more than INT_MAX bytes are
+   refused. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[700];
+
+void
+test_main (void) 
+{
+  char a[100], b[450], c[200];
+  struct iovec out[3], in[3];
+  size_t i;
+  int fd;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 253;
+  out[0].iov_base = buf;
+  out[0].iov_len = 10;
+  out[1].iov_base = buf + 10;
+  out[1].iov_len = 0;
+  out[2].iov_base = buf + 10;
+  out[2].iov_len = sizeof buf - 10;
+
+  CHECK (create ("iov", 0), "create \"iov\"");
+  CHECK ((fd = open ("iov")) > 1, "open \"iov\"");
+  CHECK (writev (fd, out, 3) == sizeof buf, "writev 3 buffers");
+  check_file ("iov", buf, sizeof buf);
+
+  seek (fd, 0);
+  in[0].iov_base = a;
+  in[0].iov_len = sizeof a;
+  in[1].iov_base = b;
+  in[1].iov_len = sizeof b;
+  in[2].iov_base = c;
+  in[2].iov_len = sizeof c;
+  CHECK (readv (fd, in, 3) == sizeof buf, "readv 3 buffers (must stop at EOF)");
+  compare_bytes (a, buf, sizeof a, 0, "iov");
+  compare_bytes (b, buf + sizeof a, sizeof b, sizeof a, "iov");
+  compare_bytes (c, buf + sizeof a + sizeof b,
+                 sizeof buf - sizeof a - sizeof b, sizeof a + sizeof b, "iov");
+
+  out[1].iov_len = 0x7ffffffc;
+  CHECK (writev (fd, out, 3) == -1, "writev over INT_MAX bytes (must fail)");
+
+  msg ("close \"iov\"");
+  close (fd);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(readv-writev) begin
+(readv-writev) create "iov"
+(readv-writev) open "iov"
+(readv-writev) writev 3 buffers
+(readv-writev) open "iov" for verification
+(readv-writev) verified contents of "iov"
+(readv-writev) close "iov"
+(readv-writev) readv 3 buffers (must stop at EOF)
+(readv-writev) writev over INT_MAX bytes (must fail)
+(readv-writev) close "iov"
+(readv-writev) end
+EOF
+pass;
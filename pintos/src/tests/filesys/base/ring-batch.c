@@ -0,0 +1,76 @@
+/* Opens, writes, seeks, reads, and closes a file through a
+   submission/completion ring, several requests per ring_enter(),
+   and checks each completion. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ring ring __attribute__ ((aligned (4096)));
+static char buf[512];
+static char block[512];
+
+/* Queues a request in the submission ring. */
+static void
+submit (int op, int fd, void *addr, unsigned len, unsigned user_data)
+{
+  struct ring_sqe *sqe = &ring.sq[ring.sq_tail % RING_SQ_CNT];
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->addr = addr;
+  sqe->len = len;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+/* Consumes the next completion, which must be for USER_DATA,
+   and returns its result. */
+static int
+reap (unsigned user_data)
+{
+  struct ring_cqe *cqe;
+
+  if (ring.cq_head == ring.cq_tail)
+    fail ("no completion for request %u", user_data);
+  cqe = &ring.cq[ring.cq_head++ % RING_CQ_CNT];
+  if (cqe->user_data != user_data)
+    fail ("completion for request %u, expected %u",
+          cqe->user_data, user_data);
+  return cqe->result;
+}
+
+void
+test_main (void) 
+{
+  size_t i;
+  int fd;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 251;
+
+  CHECK (create ("ringfile", 0), "create \"ringfile\"");
+  CHECK (ring_setup (&ring, 0), "ring_setup");
+  CHECK (!ring_setup (&ring, 0), "ring_setup again (must fail)");
+
+  submit (RING_OP_OPEN, 0, (char *) "ringfile", 0, 1);
+  submit (RING_OP_NOP, 0, NULL, 0, 2);
+  CHECK (ring_enter (0) == 2, "enter open and nop");
+  CHECK ((fd = reap (1)) > 1, "open \"ringfile\"");
+  CHECK (reap (2) == 0, "nop");
+
+  submit (RING_OP_WRITE, fd, buf, sizeof buf, 3);
+  submit (RING_OP_SEEK, fd, NULL, 100, 4);
+  submit (RING_OP_READ, fd, block, sizeof block, 5);
+  submit (RING_OP_CLOSE, fd, NULL, 0, 6);
+  submit (RING_OP_READ, fd, block, sizeof block, 7);
+  CHECK (ring_enter (0) == 5, "enter write, seek, read, close, read");
+  CHECK (reap (3) == (int) sizeof buf, "write 512 bytes");
+  CHECK (reap (4) == 0, "seek to 100");
+  CHECK (reap (5) == (int) sizeof buf - 100, "read 412 bytes");
+  compare_bytes (block, buf + 100, sizeof buf - 100, 100, "ringfile");
+  CHECK (reap (6) == 0, "close");
+  CHECK (reap (7) == -1, "read closed fd (must return -1)");
+  CHECK (ring.cq_head == ring.cq_tail, "no more completions");
+
+  check_file ("ringfile", buf, sizeof buf);
+}
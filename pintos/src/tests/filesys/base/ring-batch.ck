@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(ring-batch) begin
+(ring-batch) create "ringfile"
+(ring-batch) ring_setup
+(ring-batch) ring_setup again (must fail)
+(ring-batch) enter open and nop
+(ring-batch) open "ringfile"
+(ring-batch) nop
+(ring-batch) enter write, seek, read, close, read
+(ring-batch) write 512 bytes
+(ring-batch) seek to 100
+(ring-batch) read 412 bytes
+(ring-batch) close
+(ring-batch) read closed fd (must return -1)
+(ring-batch) no more completions
+(ring-batch) open "ringfile" for verification
+(ring-batch) verified contents of "ringfile"
+(ring-batch) close "ringfile"
+(ring-batch) end
+EOF
+pass;
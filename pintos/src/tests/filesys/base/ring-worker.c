@@ -0,0 +1,52 @@
+/* Writes a file in blocks through a submission/completion ring
+   drained by a kernel worker thread, waits for all of the
+   completions, and reads the file back. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_SIZE 128
+#define BLOCK_CNT 40
+
+static struct ring ring __attribute__ ((aligned (4096)));
+static char buf[BLOCK_SIZE * BLOCK_CNT];
+
+void
+test_main (void) 
+{
+  size_t i;
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("ringfile", 0), "create \"ringfile\"");
+  CHECK ((fd = open ("ringfile")) > 1, "open \"ringfile\"");
+  CHECK (ring_setup (&ring, RING_SETUP_WORKER), "ring_setup with worker");
+
+  for (i = 0; i < BLOCK_CNT; i++)
+    {
+      struct ring_sqe *sqe = &ring.sq[ring.sq_tail % RING_SQ_CNT];
+      sqe->op = RING_OP_WRITE;
+      sqe->fd = fd;
+      sqe->addr = buf + i * BLOCK_SIZE;
+      sqe->len = BLOCK_SIZE;
+      sqe->user_data = i;
+      ring.sq_tail++;
+    }
+  CHECK (ring_enter (BLOCK_CNT) == BLOCK_CNT, "enter %d writes", BLOCK_CNT);
+  CHECK (ring.cq_tail - ring.cq_head == BLOCK_CNT,
+         "%d completions", BLOCK_CNT);
+
+  for (i = 0; i < BLOCK_CNT; i++)
+    {
+      struct ring_cqe *cqe = &ring.cq[ring.cq_head++ % RING_CQ_CNT];
+      if (cqe->user_data != i || cqe->result != BLOCK_SIZE)
+        fail ("completion %zu: request %u returned %d",
+              i, cqe->user_data, cqe->result);
+    }
+  msg ("close \"ringfile\"");
+  close (fd);
+
+  check_file ("ringfile", buf, sizeof buf);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(ring-worker) begin
+(ring-worker) create "ringfile"
+(ring-worker) open "ringfile"
+(ring-worker) ring_setup with worker
+(ring-worker) enter 40 writes
+(ring-worker) 40 completions
+(ring-worker) close "ringfile"
+(ring-worker) open "ringfile" for verification
+(ring-worker) verified contents of "ringfile"
+(ring-worker) close "ringfile"
+(ring-worker) end
+EOF
+pass;
@@ -0,0 +1,44 @@
+/* Reads a directory with readdir_batch() and checks that each
+   entry comes back once, with the right type and inumber. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct readdir_entry entries[8];
+  bool saw_file = false, saw_dir = false;
+  int fd, file_fd, dir_fd, cnt, i;
+
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  CHECK (create ("a/file", 0), "create \"a/file\"");
+  CHECK (mkdir ("a/dir"), "mkdir \"a/dir\"");
+  CHECK ((file_fd = open ("a/file")) > 1, "open \"a/file\"");
+  CHECK ((dir_fd = open ("a/dir")) > 1, "open \"a/dir\"");
+  CHECK ((fd = open ("a")) > 1, "open \"a\"");
+
+  cnt = readdir_batch (fd, entries, sizeof entries);
+  if (cnt != 2)
+    fail ("readdir_batch returned %d entries, expected 2", cnt);
+  for (i = 0; i < cnt; i++)
+    {
+      struct readdir_entry *e = &entries[i];
+      if (!strcmp (e->name, "file") && !e->is_dir && !saw_file
+          && e->inumber == inumber (file_fd))
+        saw_file = true;
+      else if (!strcmp (e->name, "dir") && e->is_dir && !saw_dir
+               && e->inumber == inumber (dir_fd))
+        saw_dir = true;
+      else
+        fail ("unexpected entry \"%s\"", e->name);
+    }
+  msg ("readdir_batch \"a\"");
+
+  CHECK (readdir_batch (fd, entries, sizeof entries) == 0,
+         "readdir_batch at end of directory returns 0");
+  CHECK (readdir_batch (file_fd, entries, sizeof entries) == -1,
+         "readdir_batch on a file returns -1");
+}
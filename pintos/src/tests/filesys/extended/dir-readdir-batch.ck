@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-readdir-batch) begin
+(dir-readdir-batch) mkdir "a"
+(dir-readdir-batch) create "a/file"
+(dir-readdir-batch) mkdir "a/dir"
+(dir-readdir-batch) open "a/file"
+(dir-readdir-batch) open "a/dir"
+(dir-readdir-batch) open "a"
+(dir-readdir-batch) readdir_batch "a"
+(dir-readdir-batch) readdir_batch at end of directory returns 0
+(dir-readdir-batch) readdir_batch on a file returns -1
+(dir-readdir-batch) end
+EOF
+pass;
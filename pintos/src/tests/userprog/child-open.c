@@ -0,0 +1,26 @@
+/* Child process run by open-child.
+   Opens "sample.txt" before doing anything else, so that the
+   first open sets up the new process's file descriptor table,
+   and then often enough that the table has to grow. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-open";
+
+#define OPEN_CNT 40
+
+int
+main (void) 
+{
+  int i;
+
+  for (i = 0; i < OPEN_CNT; i++)
+    {
+      int fd = open ("sample.txt");
+      if (fd < 2)
+        fail ("open() #%d returned %d", i, fd);
+    }
+  msg ("opened \"sample.txt\" %d times", OPEN_CNT);
+  return 0;
+}
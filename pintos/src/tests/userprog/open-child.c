@@ -0,0 +1,12 @@
+/* Executes child-open, which opens files as the first thing a
+   new process does, and waits for it. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  msg ("wait(exec()) = %d", wait (exec ("child-open")));
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-child) begin
+(child-open) opened "sample.txt" 40 times
+child-open: exit(0)
+(open-child) wait(exec()) = 0
+(open-child) end
+open-child: exit(0)
+EOF
+pass;
@@ -0,0 +1,17 @@
+/* Verifies that a running executable cannot be mapped.  Writes
+   through the mapping could not reach the file, which denies
+   writes, and must not reach the code of running processes. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  int handle;
+
+  CHECK ((handle = open ("mmap-exec")) > 1, "open \"mmap-exec\"");
+  CHECK (mmap (handle, (void *) 0x10000000) == MAP_FAILED,
+         "try to mmap running executable");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mmap-exec) begin
+(mmap-exec) open "mmap-exec"
+(mmap-exec) try to mmap running executable
+(mmap-exec) end
+mmap-exec: exit(0)
+EOF
+pass;
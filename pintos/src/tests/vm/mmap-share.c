@@ -0,0 +1,42 @@
+/* Maps the same file twice, writes through one mapping, and
+   verifies that the data shows through the other at once and
+   reaches the file when the mapping written through is
+   unmapped. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char *actual[2] = {(char *) 0x10000000, (char *) 0x20000000};
+static const char overwrite[] = "written through one mapping";
+
+void
+test_main (void)
+{
+  size_t len = strlen (overwrite);
+  char buf[sizeof overwrite];
+  int handle[2];
+  mapid_t map[2];
+  size_t i;
+
+  for (i = 0; i < 2; i++)
+    {
+      CHECK ((handle[i] = open ("sample.txt")) > 1,
+             "open \"sample.txt\" #%zu", i);
+      CHECK ((map[i] = mmap (handle[i], actual[i])) != MAP_FAILED,
+             "mmap \"sample.txt\" #%zu at %p", i, (void *) actual[i]);
+    }
+
+  memcpy (actual[0], overwrite, len);
+  CHECK (!memcmp (actual[1], overwrite, len),
+         "compare mapping #1 against data written to #0");
+
+  munmap (map[0]);
+  CHECK (read (handle[0], buf, len) == (int) len, "read \"sample.txt\"");
+  CHECK (!memcmp (buf, overwrite, len),
+         "compare read data against data written to #0");
+  CHECK (!memcmp (actual[1], overwrite, len),
+         "compare mapping #1 against data written to #0 again");
+  munmap (map[1]);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-share) begin
+(mmap-share) open "sample.txt" #0
+(mmap-share) mmap "sample.txt" #0 at 0x10000000
+(mmap-share) open "sample.txt" #1
+(mmap-share) mmap "sample.txt" #1 at 0x20000000
+(mmap-share) compare mapping #1 against data written to #0
+(mmap-share) read "sample.txt"
+(mmap-share) compare read data against data written to #0
+(mmap-share) compare mapping #1 against data written to #0 again
+(mmap-share) end
+EOF
+pass;
@@ -0,0 +1,37 @@
+/* Runs with user memory limited to 32 pages.  Writes every page
+   of a 64-page array, which must swap some of them out, and
+   reads them all back, which must swap some of them in.  Checks
+   that getrusage reports the faults, the swapping, and a
+   resident set no larger than the limit. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_CNT 64
+#define USER_PAGES 32
+
+static char buf[PAGE_CNT * 4096];
+
+void
+test_main (void)
+{
+  struct rusage before, written, after;
+  size_t i;
+
+  getrusage (&before);
+  for (i = 0; i < PAGE_CNT; i++)
+    buf[i * 4096] = i + 1;
+  getrusage (&written);
+  for (i = 0; i < PAGE_CNT; i++)
+    if (buf[i * 4096] != (char) (i + 1))
+      fail ("page %zu was not read back intact", i);
+  getrusage (&after);
+
+  CHECK (written.minflt + written.majflt > before.minflt + before.majflt,
+         "page faults were counted");
+  CHECK (written.nswapout > 0, "pages were swapped out");
+  CHECK (after.nswapin > written.nswapin, "pages were swapped back in");
+  CHECK (after.maxrss > 0 && after.maxrss <= USER_PAGES,
+         "at most %d pages were resident", USER_PAGES);
+}
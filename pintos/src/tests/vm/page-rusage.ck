@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-rusage) begin
+(page-rusage) page faults were counted
+(page-rusage) pages were swapped out
+(page-rusage) pages were swapped back in
+(page-rusage) at most 32 pages were resident
+(page-rusage) end
+EOF
+pass;
@@ -0,0 +1,31 @@
+/* Runs with the user stack limited to 16 pages.  Grows the stack
+   to the limit, which must succeed, and then by one more byte,
+   which must terminate the process with -1 exit code. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define STACK_TOP ((char *) 0xc0000000)
+#define STACK_PAGES 16
+
+/* Writes a byte at ADDR with the stack pointer pointing there,
+   as a push would. */
+static void
+push_at (char *addr)
+{
+  asm volatile
+    ("movl %%esp, %%edx;"        /* Save a copy of the stack pointer. */
+     "movl %0, %%esp;"           /* Move stack pointer to ADDR. */
+     "movb $0, (%%esp);"         /* Write there. */
+     "movl %%edx, %%esp"         /* Restore copied stack pointer. */
+     : : "r" (addr) : "edx", "memory");
+}
+
+void
+test_main (void)
+{
+  push_at (STACK_TOP - STACK_PAGES * 4096);
+  msg ("grew stack to %d pages", STACK_PAGES);
+  push_at (STACK_TOP - STACK_PAGES * 4096 - 1);
+  fail ("grew stack past %d pages", STACK_PAGES);
+}
@@ -95,6 +95,12 @@ struct thread
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     uint32_t *pagedir;                  /* Page directory. */
+    struct process *process;            /* User process, or NULL. */
+#endif
+#ifdef VM
+    /* Owned by userprog/syscall.c. */
+    void *user_esp;                     /* User stack pointer on entry
+                                           to the current system call. */
 #endif
 
     /* Owned by thread.c. */
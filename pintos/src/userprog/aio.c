@@ -0,0 +1,289 @@
+#include "userprog/aio.h"
+#include <debug.h>
+#include <list.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+
+/* An asynchronous read or write. */
+struct aio_request
+  {
+    struct list_elem elem;      /* Element in aio_queue. */
+    struct list_elem proc_elem; /* Element in owner's aio_requests. */
+    int id;                     /* Identifier within the owner. */
+    bool write;                 /* Write rather than read? */
+    struct file *file;          /* Private handle on the file. */
+    void *ubuf;                 /* User buffer to read into. */
+    void *buf;                  /* Kernel copy of the data. */
+    off_t size;                 /* Bytes to transfer. */
+    off_t ofs;                  /* File offset. */
+    int result;                 /* Bytes transferred. */
+
+    /* Protected by aio_lock. */
+    bool queued;                /* In aio_queue? */
+    bool done;                  /* Carried out by the worker? */
+    bool orphaned;              /* Owner exited first? */
+    struct semaphore finished;  /* Upped once DONE. */
+  };
+
+/* Requests not yet picked up by the worker, oldest first. */
+static struct list aio_queue;
+
+/* Protects aio_queue and the request fields marked above. */
+static struct lock aio_lock;
+
+/* Signaled when aio_queue becomes nonempty. */
+static struct condition aio_queued;
+
+/* Has the worker thread been started? */
+static bool aio_started;
+
+static thread_func aio_worker NO_RETURN;
+static struct aio_request *aio_find (int id);
+static int aio_collect (struct aio_request *);
+static void aio_free (struct aio_request *);
+
+/* Initializes asynchronous I/O. */
+void
+aio_init (void)
+{
+  list_init (&aio_queue);
+  lock_init (&aio_lock);
+  cond_init (&aio_queued);
+}
+
+/* Queues a transfer of SIZE bytes, at most AIO_MAX_SIZE, at
+   offset OFS in FILE to or from user buffer UBUF, which the
+   caller has checked, and returns an identifier for it, or -1 on
+   failure, including when the current process already has
+   AIO_MAX_REQUESTS uncollected requests.  A write's
+   data is copied out of UBUF before returning; a read's data is
+   copied into UBUF when it is collected by aio_wait().  The
+   request uses its own handle on FILE, so FILE may be closed
+   meanwhile. */
+int
+aio_submit (struct file *file, void *ubuf, off_t size, off_t ofs, bool write)
+{
+  struct process *p = process_current ();
+  struct aio_request *r;
+
+  ASSERT (size >= 0 && size <= AIO_MAX_SIZE);
+  ASSERT (ofs >= 0);
+
+  if (list_size (&p->aio_requests) >= AIO_MAX_REQUESTS)
+    return -1;
+  r = malloc (sizeof *r);
+  if (r == NULL)
+    return -1;
+  r->buf = malloc (size > 0 ? size : 1);
+  if (r->buf == NULL)
+    {
+      free (r);
+      return -1;
+    }
+
+  /* The worker may be closing another handle on the same inode. */
+  lock_acquire (&filesys_lock);
+  r->file = file_reopen (file);
+  lock_release (&filesys_lock);
+  if (r->file == NULL)
+    {
+      free (r->buf);
+      free (r);
+      return -1;
+    }
+  if (write)
+    memcpy (r->buf, ubuf, size);
+  r->id = p->aio_next_id++;
+  r->write = write;
+  r->ubuf = ubuf;
+  r->size = size;
+  r->ofs = ofs;
+  r->result = 0;
+  r->queued = true;
+  r->done = false;
+  r->orphaned = false;
+  sema_init (&r->finished, 0);
+  list_push_back (&p->aio_requests, &r->proc_elem);
+
+  lock_acquire (&aio_lock);
+  if (!aio_started)
+    aio_started = thread_create ("aio", PRI_DEFAULT,
+                                 aio_worker, NULL) != TID_ERROR;
+  list_push_back (&aio_queue, &r->elem);
+  cond_signal (&aio_queued, &aio_lock);
+  lock_release (&aio_lock);
+  return r->id;
+}
+
+/* Waits for the current process's request ID to complete and
+   returns the number of bytes it transferred, or -1 if there is
+   no such uncollected request. */
+int
+aio_wait (int id)
+{
+  struct aio_request *r = aio_find (id);
+
+  if (r == NULL)
+    return -1;
+  sema_down (&r->finished);
+  return aio_collect (r);
+}
+
+/* Returns the identifier of the current process's oldest request
+   that has completed but not been collected, or -1 if there is
+   none.  aio_wait() on the identifier returns without
+   blocking. */
+int
+aio_poll (void)
+{
+  struct process *p = process_current ();
+  struct list_elem *e;
+  int id = -1;
+
+  lock_acquire (&aio_lock);
+  for (e = list_begin (&p->aio_requests); e != list_end (&p->aio_requests);
+       e = list_next (e))
+    {
+      struct aio_request *r = list_entry (e, struct aio_request, proc_elem);
+      if (r->done)
+        {
+          id = r->id;
+          break;
+        }
+    }
+  lock_release (&aio_lock);
+  return id;
+}
+
+/* Discards all of P's requests as P exits.  Requests still
+   queued are dropped; those the worker is carrying out are
+   freed by the worker when it is done. */
+void
+aio_release (struct process *p)
+{
+  while (!list_empty (&p->aio_requests))
+    {
+      struct list_elem *e = list_pop_front (&p->aio_requests);
+      struct aio_request *r = list_entry (e, struct aio_request, proc_elem);
+      bool busy, dropped = false;
+
+      lock_acquire (&aio_lock);
+      if (r->queued)
+        {
+          list_remove (&r->elem);
+          r->queued = false;
+          r->done = true;
+          dropped = true;
+        }
+      busy = !r->done;
+      r->orphaned = busy;
+      lock_release (&aio_lock);
+
+      if (dropped)
+        {
+          /* Under filesys_lock, as the worker closes its handles,
+             since it may be closing another handle on the same
+             inode.  The exiting thread may already hold the
+             lock. */
+          bool fs = !lock_held_by_current_thread (&filesys_lock);
+          if (fs)
+            lock_acquire (&filesys_lock);
+          file_close (r->file);
+          if (fs)
+            lock_release (&filesys_lock);
+        }
+      if (!busy)
+        aio_free (r);
+    }
+}
+
+/* Carries out queued requests one at a time. */
+static void
+aio_worker (void *aux UNUSED)
+{
+  for (;;)
+    {
+      struct aio_request *r;
+      bool orphaned;
+
+      lock_acquire (&aio_lock);
+      while (list_empty (&aio_queue))
+        cond_wait (&aio_queued, &aio_lock);
+      r = list_entry (list_pop_front (&aio_queue), struct aio_request, elem);
+      r->queued = false;
+      lock_release (&aio_lock);
+
+      /* Blocks in the buffer cache or the disk driver while the
+         owner keeps running. */
+      lock_acquire (&filesys_lock);
+      if (r->write)
+        r->result = file_write_at (r->file, r->buf, r->size, r->ofs);
+      else
+        r->result = file_read_at (r->file, r->buf, r->size, r->ofs);
+      file_close (r->file);
+      lock_release (&filesys_lock);
+
+      /* Once DONE is set the owner may free R, so wake it before
+         releasing the lock. */
+      lock_acquire (&aio_lock);
+      r->done = true;
+      orphaned = r->orphaned;
+      if (!orphaned)
+        sema_up (&r->finished);
+      lock_release (&aio_lock);
+
+      if (orphaned)
+        aio_free (r);
+    }
+}
+
+/* Returns the current process's uncollected request ID, or a
+   null pointer. */
+static struct aio_request *
+aio_find (int id)
+{
+  struct process *p = process_current ();
+  struct list_elem *e;
+
+  for (e = list_begin (&p->aio_requests); e != list_end (&p->aio_requests);
+       e = list_next (e))
+    {
+      struct aio_request *r = list_entry (e, struct aio_request, proc_elem);
+      if (r->id == id)
+        return r;
+    }
+  return NULL;
+}
+
+/* Delivers completed request R to its owner, the current
+   process, frees it, and returns its result.  A read's buffer is
+   checked again first, since the process may have unmapped it
+   since submitting; if it has, the process is killed. */
+static int
+aio_collect (struct aio_request *r)
+{
+  int result = r->result;
+
+  if (!r->write && result > 0)
+    {
+      if (!user_buffer_ok (r->ubuf, result, true))
+        sys_exit (-1);
+      memcpy (r->ubuf, r->buf, result);
+    }
+  list_remove (&r->proc_elem);
+  aio_free (r);
+  return result;
+}
+
+/* Frees R, whose file has already been closed. */
+static void
+aio_free (struct aio_request *r)
+{
+  free (r->buf);
+  free (r);
+}
@@ -0,0 +1,23 @@
+#ifndef USERPROG_AIO_H
+#define USERPROG_AIO_H
+
+#include <stdbool.h>
+#include "filesys/off_t.h"
+
+struct file;
+struct process;
+
+/* Most bytes one request may transfer.  Each request holds a
+   kernel copy of its data until it is collected. */
+#define AIO_MAX_SIZE (64 * 1024)
+
+/* Most uncollected requests per process. */
+#define AIO_MAX_REQUESTS 16
+
+void aio_init (void);
+int aio_submit (struct file *, void *, off_t size, off_t ofs, bool write);
+int aio_wait (int id);
+int aio_poll (void);
+void aio_release (struct process *);
+
+#endif /* userprog/aio.h */
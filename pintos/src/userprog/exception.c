@@ -4,13 +4,30 @@
 #include "userprog/gdt.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
 #include "userprog/process.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
+/* A kernel instruction that may fault on a user address, and the
+   address to resume at if it does.  FAULT_FIXUP in
+   userprog/syscall.c records one in section .fault_fixups for
+   each such instruction, and the linker script collects them
+   between these two symbols. */
+struct fault_fixup
+  {
+    uintptr_t insn;
+    uintptr_t resume;
+  };
+extern const struct fault_fixup _start_fault_fixups[], _end_fault_fixups[];
+
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static const struct fault_fixup *find_fault_fixup (void (*eip) (void));
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -149,11 +166,42 @@ page_fault (struct intr_frame *f)
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
 
+#ifdef VM
+  /* Bring in a page that is part of the process but has not
+     been loaded yet, give a zero-fill page that was only read so
+     far a frame of its own, or grow the stack, whether the user
+     or the kernel on its behalf touched it.  A fault in the
+     kernel comes from a system call, which saved the user's
+     stack pointer on entry. */
+  if (is_user_vaddr (fault_addr)
+      && (page_load (fault_addr, write)
+          || (not_present
+              && page_grow_stack (fault_addr,
+                                  user ? f->esp
+                                       : thread_current ()->user_esp))))
+    return;
+#endif
+
+  /* get_user() and put_user() in userprog/syscall.c expect the
+     kernel to fault on bad user addresses.  Resume after the
+     faulting instruction with -1 in EAX to report the failure.
+     Any other kernel fault is a bug, handled below. */
+  if (!user && is_user_vaddr (fault_addr))
+    {
+      const struct fault_fixup *fixup = find_fault_fixup (f->eip);
+      if (fixup != NULL)
+        {
+          f->eip = (void (*) (void)) fixup->resume;
+          f->eax = 0xffffffff;
+          return;
+        }
+    }
+
   /* To implement virtual memory, delete the rest of the function
      body, and replace it with code that brings in the page to
      which fault_addr refers. */
   if(!is_valid_usraddr(fault_addr)){
-      find_process(thread_current() -> tid)->exit_status = -1;
+      process_current()->exit_status = -1;
       thread_exit();  
   }
 
@@ -169,3 +217,15 @@ page_fault (struct intr_frame *f)
   kill (f);
 }
 
+/* Returns the fixup for the kernel instruction at EIP, or a null
+   pointer if that instruction is not expected to fault. */
+static const struct fault_fixup *
+find_fault_fixup (void (*eip) (void))
+{
+  const struct fault_fixup *fixup;
+
+  for (fixup = _start_fault_fixups; fixup < _end_fault_fixups; fixup++)
+    if (fixup->insn == (uintptr_t) eip)
+      return fixup;
+  return NULL;
+}
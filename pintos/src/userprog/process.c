@@ -12,9 +12,16 @@
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
 #include "userprog/tss.h"
+#include "userprog/ring.h"
+#include "userprog/aio.h"
+#ifdef VM
+#include "vm/mmap.h"
+#include "vm/page.h"
+#endif
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/inode.h"
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
@@ -26,27 +33,57 @@
 
 static thread_func start_process NO_RETURN;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
+static hash_hash_func process_hash;
+static hash_less_func process_less;
 
+/* Every process that has not been reaped, keyed by pid. */
+static struct hash process_table;
 
-struct list process_list;
+#ifdef VM
+/* Print each process's paging counters when it exits?  Set by
+   the -vmstat kernel option. */
+bool process_print_usage;
+#endif
+
+/* What process_execute() hands to start_process(). */
+struct exec_info
+  {
+    char *cmd_line;                     /* Page holding the command line. */
+    struct process *process;            /* The new process. */
+  };
 
 void
 process_init (void)
 {
-  list_init(&process_list);
+  hash_init(&process_table, process_hash, process_less, NULL);
 
   struct process *initial_process;
   initial_process = malloc(sizeof *initial_process);
   initial_process -> pid = thread_current() -> tid;
   initial_process -> is_dead = false;
   initial_process -> load_success = false;
-  initial_process -> fd_cnt = 2;
-  list_init(&initial_process -> file_list);
+  initial_process -> fds = NULL;
+  initial_process -> fd_cap = 0;
+  initial_process -> fd_low = 2;
+  initial_process -> cwd = NULL;
+  initial_process -> ring = NULL;
+  list_init(&initial_process -> aio_requests);
+  initial_process -> aio_next_id = 0;
+#ifdef VM
+  page_table_init(&initial_process -> pages);
+  list_init(&initial_process -> mappings);
+  initial_process -> next_mapid = 0;
+  memset(initial_process -> fault_streams, 0,
+         sizeof initial_process -> fault_streams);
+  memset(&initial_process -> usage, 0, sizeof initial_process -> usage);
+  initial_process -> resident_cnt = 0;
+#endif
   list_init(&initial_process -> children_pids);
 
   //printf("MALLOC struct process / process pid : %d ", thread_current() -> tid);
   
-  list_push_back(&process_list, &initial_process->elem);
+  hash_insert(&process_table, &initial_process->elem);
+  thread_current() -> process = initial_process;
 
 }
 /* Starts a new thread running a user program loaded from
@@ -62,7 +99,9 @@ process_execute (const char *file_name)
   tid_t tid;
 
   struct process *curr_p;
-  curr_p = find_process(thread_current()->tid);
+  struct process *child;
+  struct exec_info info;
+  curr_p = process_current();
   sema_init(&curr_p->sema_pexec, 0);
   sema_init(&curr_p->sema_pwait, 0);
 
@@ -74,42 +113,66 @@ process_execute (const char *file_name)
   strlcpy (fn_copy, file_name, PGSIZE);
 
   file_name_copy = palloc_get_page (0);
-  if (file_name_copy == NULL)
+  if (file_name_copy == NULL){
+    palloc_free_page (fn_copy);
     return TID_ERROR;
+  }
   strlcpy (file_name_copy, file_name, PGSIZE);
 
+  //0. Set up child's process structure for start_process() to pick up
+  child = malloc(sizeof *child);
+  if (child == NULL){
+    palloc_free_page (fn_copy);
+    palloc_free_page (file_name_copy);
+    return TID_ERROR;
+  }
+  child->parent_pid = thread_current()->tid;
+  list_init(&child->children_pids);
+  child->is_dead = false;
+  child->load_success = false;
+  child->exec_file = NULL;
+  child->fds = NULL;
+  child->fd_cap = 0;
+  child->fd_low = 2;
+  child->cwd = curr_p->cwd != NULL ? inode_reopen(curr_p->cwd) : NULL;
+  child->ring = NULL;
+  list_init(&child->aio_requests);
+  child->aio_next_id = 0;
+#ifdef VM
+  page_table_init(&child->pages);
+  list_init(&child->mappings);
+  child->next_mapid = 0;
+  memset(child->fault_streams, 0, sizeof child->fault_streams);
+  memset(&child->usage, 0, sizeof child->usage);
+  child->resident_cnt = 0;
+#endif
+  info.cmd_line = fn_copy;
+  info.process = child;
+
   //1. filename arg1 arg2 .. -> filename
   char *t_name;
   char *save_ptr;
   t_name = strtok_r (file_name_copy, " ", &save_ptr);  
 
   /* Create a new thread to execute FILE_NAME. */
-  tid = thread_create (t_name, PRI_DEFAULT, start_process, fn_copy);
+  tid = thread_create (t_name, PRI_DEFAULT, start_process, &info);
   if (tid == TID_ERROR){
     palloc_free_page (fn_copy); 
     palloc_free_page (file_name_copy);
-    free(t_name);
+    inode_close (child->cwd);
+    free (child);
   }
-  //2. If thread_create(child) success -> add to process_list
+  //2. If thread_create(child) success -> add to process_table
   else{
-    struct process *child;
-    child = malloc(sizeof *child);   
     child->pid = tid;
-    child->parent_pid = thread_current()->tid;
-    list_init(&child->children_pids);
-    child->is_dead = false;
-    child->load_success = false;
-    list_init(&child->file_list);
-    child->fd_cnt = 2;
-    
-    list_push_back(&process_list, &child->elem);
+    hash_insert(&process_table, &child->elem);
 
     //3. Wait until child exec
     sema_down(&curr_p->sema_pexec);
 
-    //4. If load(child) !success -> remove from process_list
+    //4. If load(child) !success -> remove from process_table
     if(!child->load_success){
-      list_remove(&child->elem);
+      hash_delete(&process_table, &child->elem);
       free(child);
       tid = -1;
     }
@@ -128,29 +191,32 @@ process_execute (const char *file_name)
 /* A thread function that loads a user process and makes it start
    running. */
 static void
-start_process (void *f_name)
+start_process (void *info_)
 {
-  char *file_name = f_name;
+  struct exec_info *info = info_;
+  char *file_name = info->cmd_line;
   struct intr_frame if_;
   bool success;
   char *token, *save_ptr;
   token = strtok_r (file_name, " ", &save_ptr); 
 
+  /* The parent is blocked until we finish loading, so INFO is
+     still valid here. */
+  thread_current ()->process = info->process;
+  info->process->pid = thread_current ()->tid;
+
   /* Initialize interrupt frame and load executable. */  
   memset (&if_, 0, sizeof if_);
   if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
   if_.cs = SEL_UCSEG;
   if_.eflags = FLAG_IF | FLAG_MBS;
 
-  //1. File_deny_write while this file's process is executing
-  struct file* file = filesys_open(token);
-  if (file != NULL) file_deny_write(file);
-
+  //1. load() keeps the executable open, denying writes, as exec_file
   success = load (token, &if_.eip, &if_.esp);
 
   //2. Hand over to parent process that whether child success or not 
   struct process *curr_p;
-  curr_p = find_process(thread_current()->tid);
+  curr_p = process_current();
   curr_p->load_success = success;
 
   struct process *parent_p;
@@ -163,13 +229,8 @@ start_process (void *f_name)
   //4. If load is not success : FREE & sys_exit(-1)
   if (!success) {
     palloc_free_page (file_name);
-    file_close(file);
     sys_exit (-1);
   }
-  //5. success : Add this file to process's exec_file
-  else{
-    curr_p->exec_file = file;
-  }
 
   /* Argument Passing */
   char **argv;
@@ -239,33 +300,27 @@ process_wait (tid_t child_tid)
 {
   struct process *curr_p;
   struct process *child_p;
-  curr_p = find_process(thread_current()->tid);
+  int exit_status;
+  curr_p = process_current();
+  child_p = find_process(child_tid);
 
   //CASE 0: Unvalid child process pid
-  if (find_process(child_tid) == NULL){
+  if (child_p == NULL){
     return -1;
   }
   //CASE 0: This is not a child of current process 
-  if (curr_p->pid != find_process(child_tid)->parent_pid){
+  if (curr_p->pid != child_p->parent_pid){
     return -1;
   }
-  else{
-    //CASE 1: child is already dead
-    if (find_process(child_tid)->is_dead){
-      int exit_status = get_exitstatus(child_tid);
-      list_remove(&find_process(child_tid)->elem);
-      free(find_process(child_tid));
-      return exit_status;
-    }
-    //CASE 2: child is not dead -> wait for child to exit
-    else{
-      sema_down(&curr_p->sema_pwait);
-      int exit_status = get_exitstatus(child_tid);
-      list_remove(&find_process(child_tid)->elem);
-      free(find_process(child_tid));
-      return exit_status;
-    }
-  } 
+  //CASE 2: child is not dead -> wait for child to exit
+  if (!child_p->is_dead){
+    sema_down(&curr_p->sema_pwait);
+  }
+  //CASE 1: child is (now) dead
+  exit_status = child_p->exit_status;
+  hash_delete(&process_table, &child_p->elem);
+  free(child_p);
+  return exit_status;
 }
 
 /* Free the current process's resources. */
@@ -287,6 +342,12 @@ process_exit (void)
        directory before destroying the process's page
        directory, or our active page directory will be one
        that's been freed (and cleared). */
+    ring_destroy (curr->process);
+    aio_release (curr->process);
+#ifdef VM
+    mmap_release (curr->process);
+    page_table_destroy (curr->process);
+#endif
     curr->pagedir = NULL;
     pagedir_activate (NULL);
     pagedir_destroy (pd);
@@ -294,71 +355,66 @@ process_exit (void)
     struct process *curr_p;
     struct process *parent_p;
     struct process *child_p;
-    curr_p = find_process(curr->tid);
+    curr_p = curr->process;
     parent_p = find_process(curr_p->parent_pid);
 
     curr_p -> is_dead = true;
     //ASSERT(curr_p->exit_status != -1);
     printf("%s: exit(%d)\n", thread_name(), curr_p->exit_status);
-
-    //CASE 0: NO Parent
-    if (parent_p == NULL){
-      list_remove(&curr_p->elem);
-      free(curr_p);
-    }
-    //CASE 1: Parent already dead
-    else if (parent_p->is_dead == true){
-      list_remove(&curr_p->elem);
-      free(curr_p);
-    }    
-
-    //CASE 2: parent is waiting for exit
-    if(!list_empty(&parent_p->sema_pwait.waiters) )
-      sema_up(&parent_p->sema_pwait);
-
-
-    //FREE: FREE (is_dead)ychildren's process structure & remove from process_list
-    if (!list_empty(&curr_p -> children_pids)){
-      struct list_elem *e;
-      struct childpid_elem *child_elem;
-      
-      e = list_begin(&curr_p -> children_pids);
-      while(e != list_end(&curr_p -> children_pids))
-      {
-        child_elem = list_entry(e, struct childpid_elem, elem);
-        child_p = find_process(child_elem->childpid);
-        e = list_next(e);
-
-        if ((child_p != NULL) && (child_p->is_dead == true)){
-          list_remove(&child_p->elem);
-          free(child_p);
-        }
-      }
-    }
-    //FREE: FREE 'file_liset'
-    struct fd_file * fd_file;
-    while (!list_empty (&curr_p->file_list))
-    {
-      struct list_elem *e = list_pop_front (&curr_p->file_list);
-      fd_file = list_entry(e, struct fd_file, elem);
-      free(fd_file->file);
-      free(fd_file);
-    }
-
-    //FREE: FREE 'childpid_elem'
+#ifdef VM
+    if (process_print_usage)
+      printf("%s: minflt %u majflt %u swapin %u swapout %u "
+             "maxrss %u iowait %u\n", thread_name(),
+             curr_p->usage.minflt, curr_p->usage.majflt,
+             curr_p->usage.nswapin, curr_p->usage.nswapout,
+             curr_p->usage.maxrss, curr_p->usage.iowait);
+#endif
+
+    //FREE: FREE (is_dead) children's process structure & remove from process_table
+    //      and FREE 'childpid_elem'
     struct childpid_elem * childpid;
     while (!list_empty (&curr_p->children_pids))
     {
       struct list_elem *e = list_pop_front (&curr_p->children_pids);
       childpid = list_entry(e, struct childpid_elem, elem);
+      child_p = find_process(childpid->childpid);
+      if ((child_p != NULL) && (child_p->is_dead == true)){
+        hash_delete(&process_table, &child_p->elem);
+        free(child_p);
+      }
       free(childpid);
     }
 
+    //FREE: close every open file and free 'fds'
+    int fd;
+    for (fd = 0; fd < curr_p->fd_cap; fd++)
+    {
+      dir_close(curr_p->fds[fd].dir);
+      file_close(curr_p->fds[fd].file);
+    }
+    free(curr_p->fds);
+    curr_p->fds = NULL;
+    curr_p->fd_cap = 0;
+
+    //FREE: close working directory
+    inode_close(curr_p->cwd);
+    curr_p->cwd = NULL;
+
     //FREE: FREE 'exec_file'
     if(curr_p->exec_file !=NULL){
         file_close (curr_p->exec_file);
         curr_p->exec_file = NULL;
     }
+
+    //CASE 0: NO Parent, CASE 1: Parent already dead -> nobody will reap us
+    if (parent_p == NULL || parent_p->is_dead == true){
+      hash_delete(&process_table, &curr_p->elem);
+      free(curr_p);
+    }
+    //CASE 2: parent is waiting for exit
+    else if(!list_empty(&parent_p->sema_pwait.waiters) )
+      sema_up(&parent_p->sema_pwait);
+    curr->process = NULL;
   }
 }
 
@@ -381,7 +437,7 @@ process_activate (void)
 void
 set_exitstatus(int status){
   struct process *curr_p;
-  curr_p = find_process(thread_current()->tid);
+  curr_p = process_current();
   curr_p -> exit_status = status;
 }
 
@@ -495,6 +551,7 @@ load (const char *file_name, void (**eip) (void), void **esp)
       printf ("load: %s: open failed\n", file_name);
       goto done; 
     }
+  file_deny_write (file);
 
   /* Read and verify executable header. */
   if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
@@ -586,15 +643,22 @@ load (const char *file_name, void (**eip) (void), void **esp)
   success = true;
 
  done:
-  /* We arrive here whether the load is successful or not. */
-  file_close (file);
+  /* We arrive here whether the load is successful or not.  On
+     success the file stays open, denying writes, until the
+     process exits: segments may be loaded from it lazily. */
+  if (success)
+    process_current ()->exec_file = file;
+  else
+    file_close (file);
 
   return success;
 }
 
 /* load() helpers. */
 
+#ifndef VM
 static bool install_page (void *upage, void *kpage, bool writable);
+#endif
 
 /* Checks whether PHDR describes a valid, loadable segment in
    FILE and returns true if so, false otherwise. */
@@ -659,6 +723,27 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (ofs % PGSIZE == 0);
 
+#ifdef VM
+  /* Only record where each page comes from.  page_load() reads
+     it in when the process first touches it.  Read-only pages of
+     the file are shared with every process running the same
+     executable. */
+  while (read_bytes > 0 || zero_bytes > 0) 
+    {
+      size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
+      size_t page_zero_bytes = PGSIZE - page_read_bytes;
+
+      if (!page_add (upage, file, ofs, page_read_bytes, writable,
+                     !writable && page_read_bytes > 0))
+        return false;
+
+      read_bytes -= page_read_bytes;
+      zero_bytes -= page_zero_bytes;
+      ofs += page_read_bytes;
+      upage += PGSIZE;
+    }
+  return true;
+#else
   file_seek (file, ofs);
   while (read_bytes > 0 || zero_bytes > 0) 
     {
@@ -694,6 +779,7 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
       upage += PGSIZE;
     }
   return true;
+#endif
 }
 
 /* Create a minimal stack by mapping a zeroed page at the top of
@@ -701,6 +787,14 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
 static bool
 setup_stack (void **esp) 
 {
+#ifdef VM
+  uint8_t *upage = ((uint8_t *) PHYS_BASE) - PGSIZE;
+
+  if (!page_add (upage, NULL, 0, 0, true, false) || !page_load (upage, true))
+    return false;
+  *esp = PHYS_BASE;
+  return true;
+#else
   uint8_t *kpage;
   bool success = false;
 
@@ -715,6 +809,7 @@ setup_stack (void **esp)
         palloc_free_page (kpage);
     }
   return success;
+#endif
 }
 
 /* Adds a mapping from user virtual address UPAGE to kernel
@@ -726,6 +821,7 @@ setup_stack (void **esp)
    with palloc_get_page().
    Returns true on success, false if UPAGE is already mapped or
    if memory allocation fails. */
+#ifndef VM
 static bool
 install_page (void *upage, void *kpage, bool writable)
 {
@@ -736,65 +832,107 @@ install_page (void *upage, void *kpage, bool writable)
   return (pagedir_get_page (t->pagedir, upage) == NULL
           && pagedir_set_page (t->pagedir, upage, kpage, writable));
 }
+#endif
 
 
-struct list_elem *
-find_processelem(tid_t pid){
-  struct list_elem *e;
-  struct process *p;
-  for(e = list_begin(&process_list); e!= list_end(&process_list); e = list_next(e)){
-    p = list_entry(e, struct process, elem);
-    if (p->pid == pid){
-      break;
-    }
-  }
-  return e;
+/* Returns the current thread's process, or a null pointer for a
+   kernel thread. */
+struct process *
+process_current (void)
+{
+  return thread_current ()->process;
 }
 
+/* Returns the process with the given PID, or a null pointer if
+   there is none. */
 struct process *
 find_process(tid_t pid){
-  struct process *p;
-  struct list_elem *e;
-  if (list_empty(&process_list))
-    return NULL;
-  e = find_processelem(pid);
+  struct process p;
+  struct hash_elem *e;
 
-  if (e == list_end(&process_list)){    //there's no pid process in process list
-    return NULL;
-  }
-  else{
-    p = list_entry(e, struct process, elem);
-  return p;
-  } 
+  p.pid = pid;
+  e = hash_find(&process_table, &p.elem);
+  return e != NULL ? hash_entry(e, struct process, elem) : NULL;
 }
 
-struct list_elem *
-find_fileelem(int fd){
-  struct process * p;
-  p = find_process(thread_current()->tid);
-  struct fd_file *fd_file;
-  struct list_elem *e;
-  for(e = list_begin(&p->file_list); e!= list_end(&p->file_list); e = list_next(e)){
-    fd_file = list_entry(e, struct fd_file, elem);
-    if (fd_file->fd == fd){
-      break;
-    }
-  }
-  return e;
+/* Returns a hash value for process E. */
+static unsigned
+process_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_int (hash_entry (e, struct process, elem)->pid);
+}
+
+/* Returns true if process A's pid is less than process B's. */
+static bool
+process_less (const struct hash_elem *a, const struct hash_elem *b,
+              void *aux UNUSED)
+{
+  return (hash_entry (a, struct process, elem)->pid
+          < hash_entry (b, struct process, elem)->pid);
+}
+
+/* Returns the working directory of the current process, or a
+   null pointer if it is the root directory or the current thread
+   is not a user process.  The caller must not close it. */
+struct inode *
+process_get_cwd (void)
+{
+  struct process *p = process_current ();
+  return p != NULL ? p->cwd : NULL;
 }
 
+/* Returns the slot for FD in the current process's descriptor
+   table, or a null pointer if FD is not open. */
 struct fd_file *
 find_file(int fd){
-  struct fd_file *fd_file;
-  struct list_elem *e;
-  if (list_empty(&find_process(thread_current()->tid)->file_list))
+  struct process *p = process_current();
+
+  if (fd < 0 || fd >= p->fd_cap || p->fds[fd].file == NULL)
     return NULL;
-  e = find_fileelem(fd);
-  if ( e == list_end(&find_process(thread_current()->tid)->file_list))
-    return NULL;    
-  else
-    fd_file = list_entry(e, struct fd_file, elem);
-  return fd_file;
+  return &p->fds[fd];
+}
+
+/* Installs FILE, whose directory is DIR if it is one, at the
+   lowest free fd of the current process, growing the table if
+   it is full.  Returns the fd, or -1 if memory is exhausted. */
+int
+add_file(struct file *file, struct dir *dir){
+  struct process *p = process_current();
+  int fd;
+
+  for (fd = p->fd_low; fd < p->fd_cap; fd++)
+    if (p->fds[fd].file == NULL)
+      break;
+  if (fd >= p->fd_cap){
+    int new_cap = p->fd_cap > 0 ? p->fd_cap * 2 : 16;
+    struct fd_file *new_fds;
+
+    while (fd >= new_cap)
+      new_cap *= 2;
+    new_fds = realloc(p->fds, new_cap * sizeof *new_fds);
+    if (new_fds == NULL)
+      return -1;
+    memset(new_fds + p->fd_cap, 0, (new_cap - p->fd_cap) * sizeof *new_fds);
+    p->fds = new_fds;
+    p->fd_cap = new_cap;
+  }
+
+  p->fds[fd].file = file;
+  p->fds[fd].dir = dir;
+  p->fd_low = fd + 1;
+  return fd;
+}
+
+/* Frees the slot for FD in the current process's descriptor
+   table.  The caller closes the file and directory. */
+void
+remove_file(int fd){
+  struct process *p = process_current();
+
+  p->fds[fd].file = NULL;
+  p->fds[fd].dir = NULL;
+  if (fd < p->fd_low)
+    p->fd_low = fd;
 }
 
 bool
@@ -4,13 +4,18 @@
 
 #include "threads/thread.h"
 #include <list.h>
+#include <hash.h>
 #include "threads/synch.h"
+#ifdef VM
+#include <syscall-nr.h>
+#include "vm/page.h"
+#endif
 
+/* A slot in a process's file descriptor table, free if FILE is NULL */
 struct fd_file
 {
-	int fd;
 	struct file* file;
-	struct list_elem elem;
+	struct dir *dir;				/* FILE's directory if it is one, otherwise NULL */
 };
 
 /* process의 childeren_pids에 저장해 주기 위한 struct 
@@ -21,7 +26,7 @@ struct childpid_elem
 	struct list_elem elem;
 };
 
-/* load success 한 process를 process_list에 넣어주기 위한 struct */
+/* load success 한 process를 process_table에 넣어주기 위한 struct */
 struct process
 {
 	tid_t pid;
@@ -35,12 +40,25 @@ struct process
 	bool is_dead;					/* 이 process가 exit 했는지 */
 	int exit_status;				/* exit 했다면 exit_status 가 뭐였는지 */
 		
-	/* Process's file list */
-	int fd_cnt;
+	/* Process's file descriptor table, indexed by fd */
 	struct file * exec_file;		/* 이 process의 exec file를 process가 exit 할 때 free 해주기 위해서 */
-	struct list file_list;			/* 이 process가 open 한 file_list */
+	struct fd_file *fds;			/* fds[fd] for 0 <= fd < fd_cap, grown by doubling */
+	int fd_cap;						/* Number of slots in fds */
+	int fd_low;						/* No free slot below this fd */
+	struct inode *cwd;				/* Working directory, NULL for the root directory */
+	struct ring_ctx *ring;			/* Submission/completion ring, or NULL */
+	struct list aio_requests;		/* Uncollected asynchronous I/O requests */
+	int aio_next_id;				/* Identifier for the next aio request */
+#ifdef VM
+	struct hash pages;				/* Supplemental page table, see vm/page.c */
+	struct list mappings;			/* Memory-mapped files, see vm/mmap.c */
+	int next_mapid;					/* Identifier for the next mapping */
+	struct fault_stream fault_streams[FAULT_STREAM_CNT]; /* For fault-around */
+	struct rusage usage;			/* Paging counters, see getrusage */
+	unsigned resident_cnt;			/* Pages now in frames */
+#endif
 
-	struct list_elem elem;
+	struct hash_elem elem;			/* Element in process_table, keyed by pid */
 };
 
 void process_init (void);
@@ -51,9 +69,15 @@ void process_activate (void);
 
 void set_exitstatus(int);
 int get_exitstatus(tid_t);
+struct process * process_current (void);
 struct process * find_process(tid_t);
-struct list_elem * find_processelem(tid_t);
-struct list_elem * find_fileelem(int);
 struct fd_file * find_file(int);
+int add_file(struct file *, struct dir *);
+void remove_file(int);
+struct inode * process_get_cwd (void);
 bool is_valid_usraddr (void *);
+
+#ifdef VM
+extern bool process_print_usage;
+#endif
 #endif /* userprog/process.h */
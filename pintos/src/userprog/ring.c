@@ -0,0 +1,281 @@
+#include "userprog/ring.h"
+#include <debug.h>
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
+
+/* Kernel side of a process's submission/completion ring. */
+struct ring_ctx
+  {
+    struct ring *ring;          /* Kernel alias of the process's ring. */
+    struct ring *uring;         /* User address of the ring, pinned. */
+    struct process *process;    /* Owning process. */
+    uint32_t *pagedir;          /* Owning process's page directory. */
+
+    /* Only used with a worker thread. */
+    bool worker;                /* Drained by a worker thread? */
+    struct lock lock;           /* Serializes fd use with the owner. */
+    struct semaphore work;      /* Upped to wake the worker. */
+    struct condition idle;      /* Signaled when BUSY becomes false. */
+    bool busy;                  /* Worker has been woken, not yet done? */
+    bool stopping;              /* Worker should exit? */
+    struct semaphore exited;    /* Upped by the worker as it exits. */
+  };
+
+static thread_func ring_worker NO_RETURN;
+static int ring_drain (struct ring_ctx *);
+static int ring_execute (const struct ring_sqe *);
+
+/* Registers RING, which lies in the current process's address
+   space, as the process's submission/completion ring.  With
+   RING_SETUP_WORKER in FLAGS, requests are carried out by a
+   kernel thread, so ring_enter() need not wait for them.
+   Returns false if the process already has a ring or RING is
+   not a writable region within one page. */
+bool
+ring_setup (struct ring *ring, unsigned flags)
+{
+  struct process *p = process_current ();
+  struct ring_ctx *ctx;
+
+  if (p->ring != NULL || pg_ofs (ring) + sizeof *ring > PGSIZE
+      || !user_buffer_ok (ring, sizeof *ring, true))
+    return false;
+
+  ctx = malloc (sizeof *ctx);
+  if (ctx == NULL)
+    return false;
+#ifdef VM
+  /* Keep the ring where the kernel alias below points. */
+  if (!page_pin (ring, sizeof *ring))
+    {
+      free (ctx);
+      return false;
+    }
+#endif
+  ctx->pagedir = thread_current ()->pagedir;
+  ctx->ring = pagedir_get_page (ctx->pagedir, ring);
+  ASSERT (ctx->ring != NULL);
+  ctx->uring = ring;
+  ctx->process = p;
+  ctx->worker = (flags & RING_SETUP_WORKER) != 0;
+  lock_init (&ctx->lock);
+  sema_init (&ctx->work, 0);
+  cond_init (&ctx->idle);
+  ctx->busy = false;
+  ctx->stopping = false;
+  sema_init (&ctx->exited, 0);
+
+  if (ctx->worker
+      && thread_create ("ring", PRI_DEFAULT, ring_worker, ctx) == TID_ERROR)
+    {
+#ifdef VM
+      page_unpin (ring, sizeof *ring);
+#endif
+      free (ctx);
+      return false;
+    }
+  p->ring = ctx;
+  return true;
+}
+
+/* Hands the requests submitted to the current process's ring to
+   the kernel and returns how many there were, or -1 if the
+   process has no ring.  Without a worker, the requests are
+   carried out before returning.  With one, waits only until at
+   least MIN_COMPLETE completions are ready to be consumed or the
+   worker runs out of requests. */
+int
+ring_enter (unsigned min_complete)
+{
+  struct process *p = process_current ();
+  struct ring_ctx *ctx = p->ring;
+  struct ring *r;
+  int cnt;
+
+  if (ctx == NULL)
+    return -1;
+  if (!ctx->worker)
+    return ring_drain (ctx);
+
+  r = ctx->ring;
+  lock_acquire (&ctx->lock);
+  cnt = r->sq_tail - r->sq_head;
+  ctx->busy = true;
+  sema_up (&ctx->work);
+  while (ctx->busy && r->cq_tail - r->cq_head < min_complete)
+    cond_wait (&ctx->idle, &ctx->lock);
+  lock_release (&ctx->lock);
+  return cnt;
+}
+
+/* Releases P's ring, stopping its worker thread if it has one,
+   and takes back the ring page's pin.  Called by P as it exits,
+   before its page directory is destroyed. */
+void
+ring_destroy (struct process *p)
+{
+  struct ring_ctx *ctx = p->ring;
+
+  if (ctx == NULL)
+    return;
+  if (ctx->worker)
+    {
+      /* We may be exiting from a system call that holds the
+         lock. */
+      if (lock_held_by_current_thread (&ctx->lock))
+        lock_release (&ctx->lock);
+      ctx->stopping = true;
+      sema_up (&ctx->work);
+      sema_down (&ctx->exited);
+    }
+#ifdef VM
+  page_unpin (ctx->uring, sizeof *ctx->uring);
+#endif
+  p->ring = NULL;
+  free (ctx);
+}
+
+/* If the current process has a ring worker, waits until it is
+   not operating on the process's file descriptors and keeps it
+   from doing so until ring_release().  Returns true if it did
+   so. */
+bool
+ring_acquire (void)
+{
+  struct process *p = process_current ();
+
+  if (p == NULL || p->ring == NULL || !p->ring->worker)
+    return false;
+  lock_acquire (&p->ring->lock);
+  return true;
+}
+
+/* Lets the ring worker locked out by ring_acquire() run again. */
+void
+ring_release (void)
+{
+  lock_release (&process_current ()->ring->lock);
+}
+
+/* Worker thread for the ring in CTX_.  Runs in its owner's
+   address space with its owner's file descriptors, so that the
+   requests mean what they would in a system call. */
+static void
+ring_worker (void *ctx_)
+{
+  struct ring_ctx *ctx = ctx_;
+  struct thread *t = thread_current ();
+
+  t->pagedir = ctx->pagedir;
+  t->process = ctx->process;
+  process_activate ();
+
+  for (;;)
+    {
+      sema_down (&ctx->work);
+      if (ctx->stopping)
+        break;
+
+      lock_acquire (&ctx->lock);
+      ring_drain (ctx);
+      ctx->busy = false;
+      cond_broadcast (&ctx->idle, &ctx->lock);
+      lock_release (&ctx->lock);
+    }
+
+  /* Give back the owner's address space before the owner
+     destroys it, and so that thread_exit() does not treat us as
+     a process. */
+  t->pagedir = NULL;
+  t->process = NULL;
+  process_activate ();
+  sema_up (&ctx->exited);
+  thread_exit ();
+}
+
+/* Carries out the requests in CTX's submission ring, in order,
+   posting each result to the completion ring.  Stops early if
+   the completion ring fills up.  Returns the number of requests
+   carried out. */
+static int
+ring_drain (struct ring_ctx *ctx)
+{
+  struct ring *r = ctx->ring;
+  int cnt = 0;
+
+  while (r->sq_head != r->sq_tail && r->cq_tail - r->cq_head < RING_CQ_CNT)
+    {
+      /* The process may rewrite the entry once sq_head passes
+         it, so work from a copy. */
+      struct ring_sqe sqe = r->sq[r->sq_head % RING_SQ_CNT];
+      struct ring_cqe *cqe = &r->cq[r->cq_tail % RING_CQ_CNT];
+
+      barrier ();
+      r->sq_head++;
+      cqe->user_data = sqe.user_data;
+      cqe->result = ring_execute (&sqe);
+      barrier ();
+      r->cq_tail++;
+      cnt++;
+    }
+  return cnt;
+}
+
+/* Carries out SQE as the corresponding system call and returns
+   its result.  Where the system call would kill the process,
+   because of a bad pointer or file descriptor, returns -1
+   instead: the worker thread must not exit on its owner's
+   behalf.  Reads from the console also fail, since they could
+   wait indefinitely for a key while holding up the owner's
+   system calls and its exit. */
+static int
+ring_execute (const struct ring_sqe *sqe)
+{
+  bool is_file = sqe->fd > 1 && find_file (sqe->fd) != NULL;
+
+  switch (sqe->op)
+    {
+    case RING_OP_NOP:
+      return 0;
+
+    case RING_OP_OPEN:
+      if (!user_string_ok (sqe->addr))
+        return -1;
+      return sys_open (sqe->addr);
+
+    case RING_OP_READ:
+      if (!is_file || sqe->addr == NULL
+          || !user_buffer_ok (sqe->addr, sqe->len, true))
+        return -1;
+      return sys_read (sqe->fd, sqe->addr, sqe->len);
+
+    case RING_OP_WRITE:
+      if ((!is_file && sqe->fd != 1)
+          || !user_buffer_ok (sqe->addr, sqe->len, false))
+        return -1;
+      return sys_write (sqe->fd, sqe->addr, sqe->len);
+
+    case RING_OP_CLOSE:
+      if (!is_file)
+        return -1;
+      sys_close (sqe->fd);
+      return 0;
+
+    case RING_OP_SEEK:
+      if (!is_file)
+        return -1;
+      sys_seek (sqe->fd, sqe->len);
+      return 0;
+
+    default:
+      return -1;
+    }
+}
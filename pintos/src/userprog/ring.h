@@ -0,0 +1,15 @@
+#ifndef USERPROG_RING_H
+#define USERPROG_RING_H
+
+#include <stdbool.h>
+#include <syscall-nr.h>
+
+struct process;
+
+bool ring_setup (struct ring *, unsigned flags);
+int ring_enter (unsigned min_complete);
+void ring_destroy (struct process *);
+bool ring_acquire (void);
+void ring_release (void);
+
+#endif /* userprog/ring.h */
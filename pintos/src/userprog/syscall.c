@@ -1,5 +1,6 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
+#include <limits.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
@@ -7,12 +8,42 @@
 #include "threads/malloc.h"
 #include "threads/init.h"
 #include "threads/vaddr.h"
+#include <string.h>
 #include "filesys/filesys.h"
 #include "userprog/pagedir.h"
 #include "filesys/file.h"
+#include "filesys/directory.h"
+#include "filesys/inode.h"
 #include "devices/input.h"
+#include "devices/timer.h"
+#include "userprog/gdt.h"
+#include "userprog/tss.h"
+#include "userprog/ring.h"
+#include "userprog/aio.h"
+#ifdef VM
+#include "vm/mmap.h"
+#include "vm/page.h"
+#endif
+
+/* Model-specific registers that configure sysenter. */
+#define MSR_SYSENTER_CS 0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
+
+/* Fast system call entry point, in threads/intr-stubs.S. */
+void sysenter_entry (void);
 
 static void syscall_handler (struct intr_frame *);
+static bool syscall_may_block (uint32_t, uint32_t *);
+static int get_user (const uint8_t *);
+static bool put_user (uint8_t *, uint8_t);
+static void copy_from_user (void *, const void *, size_t);
+static void check_user_buffer (const void *, size_t, bool);
+static void check_user_string (const char *);
+static bool pin_user_buffer (const void *, size_t);
+static void unpin_user_buffer (const void *, size_t);
+static bool cpu_has_sysenter (void);
+static void wrmsr (uint32_t, uint32_t);
 struct lock filesys_lock;
 
 void
@@ -20,125 +51,422 @@ syscall_init (void)
 {
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
   lock_init(&filesys_lock);
+  aio_init();
+
+  /* sysenter lands on a stack holding only the address of the
+     TSS's esp0, which the entry stub swaps in as its real stack.
+     That way a context switch does not have to rewrite the MSR.
+     int $0x30 keeps working either way. */
+  if (cpu_has_sysenter()){
+    wrmsr(MSR_SYSENTER_CS, SEL_KCSEG);
+    wrmsr(MSR_SYSENTER_ESP, (uint32_t) tss_esp0_addr());
+    wrmsr(MSR_SYSENTER_EIP, (uint32_t) sysenter_entry);
+  }
+}
+
+/* Returns true if the CPU implements sysenter and sysexit.
+   Early Pentium Pros report the feature without supporting it. */
+static bool
+cpu_has_sysenter (void)
+{
+  uint32_t eax, ebx, ecx, edx;
+
+  asm volatile ("cpuid"
+                : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                : "a" (1));
+  if ((edx & (1 << 11)) == 0)
+    return false;
+  return !((eax >> 8 & 0xf) == 6 && (eax >> 4 & 0xf) < 3 && (eax & 0xf) < 3);
+}
+
+/* Writes VALUE to model-specific register MSR. */
+static void
+wrmsr (uint32_t msr, uint32_t value)
+{
+  asm volatile ("wrmsr" : : "c" (msr), "a" (value), "d" (0));
 }
 
 static void
 syscall_handler (struct intr_frame *f) 
 {
   uint32_t *sp = f->esp;
-  uint32_t *argv[3];
+  uint32_t argv[4];
+  uint32_t number;
 
-  if(!is_valid_usraddr(sp)){
-  	sys_exit(-1);
-  }
+  bool ring_locked;
+
+#ifdef VM
+  /* Page faults on the user stack during the call need it. */
+  thread_current()->user_esp = f->esp;
+#endif
+  copy_from_user(&number, sp, sizeof number);
+
+  /* Keep the process's ring worker away from its file
+     descriptors meanwhile, unless the call may block for long. */
+  ring_locked = !syscall_may_block(number, sp) && ring_acquire();
 
-  switch (*sp) {
+  switch (number) {
     case SYS_HALT :
     	sys_halt();
     	break;
 
     case SYS_EXIT :
       syscall_arguments(argv, sp, 1);
-    	sys_exit((int)*argv[0]);
+    	sys_exit((int)argv[0]);
     break;
 
     case SYS_EXEC :   
       syscall_arguments(argv, sp, 1);          
-    	f -> eax = sys_exec((char *)*(uint32_t *)argv[0]);
+    	f -> eax = sys_exec((char *)argv[0]);
     break;
 
     case SYS_WAIT :
       syscall_arguments(argv, sp, 1);
-    	f -> eax = sys_wait((tid_t)*argv[0]);
+    	f -> eax = sys_wait((tid_t)argv[0]);
     	break;        
 
     case SYS_CREATE :
       syscall_arguments(argv, sp, 2);               
-    	f -> eax = sys_create((char *)*(uint32_t *)argv[0], (unsigned)*argv[1]);
+    	f -> eax = sys_create((char *)argv[0], (unsigned)argv[1]);
     	break;
 
     case SYS_REMOVE :   
       syscall_arguments(argv, sp, 1);     
-    	f -> eax = sys_remove((char *)*(uint32_t *)argv[0]);
+    	f -> eax = sys_remove((char *)argv[0]);
     	break;
 
     case SYS_OPEN :  
       syscall_arguments(argv, sp, 1);
-    	f->eax = sys_open((char *)*(uint32_t *)argv[0]);
+    	f->eax = sys_open((char *)argv[0]);
     	break;
 
     case SYS_FILESIZE :
       syscall_arguments(argv, sp, 1);
-    	f->eax = sys_filesize((int)*argv[0]);
+    	f->eax = sys_filesize((int)argv[0]);
     	break;
 
     case SYS_READ :   
       syscall_arguments(argv, sp, 3);
-    	f->eax = (off_t) sys_read((int)*argv[0], (void *)*(uint32_t *)argv[1], (unsigned) * argv[2]);
+    	f->eax = (off_t) sys_read((int)argv[0], (void *)argv[1], (unsigned)argv[2]);
     	break;
 
     case SYS_WRITE : 
       syscall_arguments(argv, sp, 3);
-    	f->eax = sys_write((int)*argv[0], (void *)*(uint32_t *)argv[1], (unsigned) *argv[2]);
+    	f->eax = sys_write((int)argv[0], (void *)argv[1], (unsigned)argv[2]);
     	break;
 
     case SYS_SEEK :
       syscall_arguments(argv, sp, 2);
-      sys_seek((int)*argv[0], (unsigned)*argv[1]);
+      sys_seek((int)argv[0], (unsigned)argv[1]);
     	break;
 
     case SYS_TELL :  
       syscall_arguments(argv, sp, 1);
-    	f->eax = sys_tell((int)*argv[0]);
+    	f->eax = sys_tell((int)argv[0]);
     	break;
 
     case SYS_CLOSE : 
       syscall_arguments(argv, sp, 1);
-    	sys_close((int)*argv[0]);
+    	sys_close((int)argv[0]);
     	break;
 
-      /*
+#ifdef VM
+    case SYS_MMAP :
+      syscall_arguments(argv, sp, 2);
+      f->eax = sys_mmap((int)argv[0], (void *)argv[1]);
+      break;
+
+    case SYS_MUNMAP :
+      syscall_arguments(argv, sp, 1);
+      sys_munmap((int)argv[0]);
+      break;
+#endif
+
     case SYS_CHDIR :
       syscall_arguments(argv, sp, 1);
-      f->eax = sys_chidr((const char *)*argv[0]);
+      f->eax = sys_chdir((const char *)argv[0]);
       break;
 
     case SYS_MKDIR :
       syscall_arguments(argv, sp, 1);
-      f->eax = sys_mkdir((const char *)*argv[0]);
+      f->eax = sys_mkdir((const char *)argv[0]);
       break;
 
     case SYS_READDIR :
       syscall_arguments(argv, sp, 2);
-      f->eax = sys_readdir((int)*argv[0], (char name[READDIR_MAK_LEN +1])(uint32_t *)*argv[1]);
+      f->eax = sys_readdir((int)argv[0], (char *)argv[1]);
       break;
 
     case SYS_ISDIR :
       syscall_arguments(argv, sp, 1);
-      f->eax = sys_isdir((int)*argv[0]);
+      f->eax = sys_isdir((int)argv[0]);
       break;
 
     case SYS_INUMBER :
       syscall_arguments(argv, sp, 1);
-      f->eax = sys_inumber((int)*argv[0]);
+      f->eax = sys_inumber((int)argv[0]);
+      break;
+
+    case SYS_READDIR_BATCH :
+      syscall_arguments(argv, sp, 3);
+      f->eax = sys_readdir_batch((int)argv[0], (void *)argv[1], (unsigned)argv[2]);
+      break;
+
+    case SYS_PREAD :
+      syscall_arguments(argv, sp, 4);
+      f->eax = sys_pread((int)argv[0], (void *)argv[1], (unsigned)argv[2], (unsigned)argv[3]);
+      break;
+
+    case SYS_PWRITE :
+      syscall_arguments(argv, sp, 4);
+      f->eax = sys_pwrite((int)argv[0], (const void *)argv[1], (unsigned)argv[2], (unsigned)argv[3]);
+      break;
+
+    case SYS_READV :
+      syscall_arguments(argv, sp, 3);
+      f->eax = sys_readv((int)argv[0], (const struct iovec *)argv[1], (int)argv[2]);
+      break;
+
+    case SYS_WRITEV :
+      syscall_arguments(argv, sp, 3);
+      f->eax = sys_writev((int)argv[0], (const struct iovec *)argv[1], (int)argv[2]);
+      break;
+
+    case SYS_COPY_FILE_RANGE :
+      syscall_arguments(argv, sp, 3);
+      f->eax = sys_copy_file_range((int)argv[0], (int)argv[1], (unsigned)argv[2]);
+      break;
+
+    case SYS_NULL :
+      sys_null();
+      break;
+
+    case SYS_RING_SETUP :
+      syscall_arguments(argv, sp, 2);
+      f->eax = ring_setup((struct ring *)argv[0], (unsigned)argv[1]);
+      break;
+
+    case SYS_RING_ENTER :
+      syscall_arguments(argv, sp, 1);
+      f->eax = ring_enter((unsigned)argv[0]);
+      break;
+
+    case SYS_AIO_READ :
+      syscall_arguments(argv, sp, 4);
+      f->eax = sys_aio_read((int)argv[0], (void *)argv[1], (unsigned)argv[2], (unsigned)argv[3]);
+      break;
+
+    case SYS_AIO_WRITE :
+      syscall_arguments(argv, sp, 4);
+      f->eax = sys_aio_write((int)argv[0], (const void *)argv[1], (unsigned)argv[2], (unsigned)argv[3]);
+      break;
+
+    case SYS_AIO_WAIT :
+      syscall_arguments(argv, sp, 1);
+      f->eax = aio_wait((int)argv[0]);
+      break;
+
+    case SYS_AIO_POLL :
+      f->eax = aio_poll();
+      break;
+
+    case SYS_POLL :
+      syscall_arguments(argv, sp, 3);
+      f->eax = sys_poll((struct pollfd *)argv[0], (unsigned)argv[1], (int)argv[2]);
+      break;
+
+#ifdef VM
+    case SYS_GETRUSAGE :
+      syscall_arguments(argv, sp, 1);
+      sys_getrusage((struct rusage *)argv[0]);
       break;
-*/
+#endif
   }
+
+  if (ring_locked)
+    ring_release();
 }
 
 
-void
-syscall_arguments(uint32_t **argv, uint32_t *sp, int argc) {
-  int i;
+/* Returns true if system call NUMBER, whose arguments are above
+   SP, may block indefinitely: waiting for a child, for ring or
+   aio requests, or for console input.  Such calls must not lock
+   out the ring worker, and do not use the descriptor table while
+   they wait. */
+static bool
+syscall_may_block (uint32_t number, uint32_t *sp)
+{
+  int fd;
 
-  for (i = 0; i < argc; i++){
-    sp++;
-    if(!is_valid_usraddr((void *)sp))
-      sys_exit(-1);  
-    argv[i] = sp;
+  switch (number) {
+    case SYS_WAIT :
+    case SYS_RING_ENTER :
+    case SYS_AIO_WAIT :
+    case SYS_POLL :
+      return true;
+
+    case SYS_READ :
+    case SYS_READV :
+      copy_from_user(&fd, sp + 1, sizeof fd);
+      return fd == 0;
+
+    default :
+      return false;
   }
 }
 
+/* Copies the ARGC arguments above the syscall number at SP into
+   ARGV. */
+void
+syscall_arguments(uint32_t *argv, uint32_t *sp, int argc) {
+  copy_from_user(argv, sp + 1, argc * sizeof *argv);
+}
+
+/* Tells page_fault() that the instruction at local label 0 may
+   fault on a user address, and that it should then resume at
+   local label 1 with EAX set to -1, by recording both addresses
+   in section .fault_fixups.  Any other kernel fault on a user
+   address is treated as a kernel bug. */
+#define FAULT_FIXUP                             \
+  ".pushsection .fault_fixups, \"a\"\n"         \
+  ".long 0b, 1b\n"                              \
+  ".popsection\n"
+
+/* Reads a byte at user virtual address UADDR, which must be below
+   PHYS_BASE.  Returns the byte value if successful, -1 if a
+   segfault occurred, in which case page_fault() resumed execution
+   at the label with EAX set to -1. */
+static int
+get_user (const uint8_t *uaddr)
+{
+  int result;
+  asm ("0: movzbl %1, %0\n"
+       "1:\n"
+       FAULT_FIXUP
+       : "=&a" (result) : "m" (*uaddr));
+  return result;
+}
+
+/* Writes BYTE to user address UDST, which must be below
+   PHYS_BASE.  Returns true if successful, false if a segfault
+   occurred. */
+static bool
+put_user (uint8_t *udst, uint8_t byte)
+{
+  int error_code;
+  asm ("movl $0, %0\n"
+       "0: movb %b2, %1\n"
+       "1:\n"
+       FAULT_FIXUP
+       : "=&a" (error_code), "=m" (*udst) : "q" (byte));
+  return error_code != -1;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address DST.
+   Kills the process if any of the bytes cannot be read. */
+static void
+copy_from_user (void *dst_, const void *usrc_, size_t size)
+{
+  uint8_t *dst = dst_;
+  const uint8_t *usrc = usrc_;
+
+  if (usrc + size < usrc || !is_user_vaddr (usrc + size))
+    sys_exit (-1);
+  for (; size > 0; size--)
+    {
+      int byte = get_user (usrc++);
+      if (byte == -1)
+        sys_exit (-1);
+      *dst++ = byte;
+    }
+}
+
+/* Returns true if all SIZE bytes at user address UADDR can be
+   read and, if WRITABLE, written.  Touches one byte per page, so
+   that afterward the kernel can access the buffer directly
+   without faulting. */
+bool
+user_buffer_ok (const void *uaddr_, size_t size, bool writable)
+{
+  uint8_t *uaddr = (uint8_t *) uaddr_;
+  uint8_t *end = uaddr + size;
+  uint8_t *p;
+
+  if (size == 0)
+    return true;
+  if (end < uaddr || !is_user_vaddr (end))
+    return false;
+  for (p = uaddr; p < end; p = (uint8_t *) pg_round_down (p) + PGSIZE)
+    {
+      int byte = get_user (p);
+      if (byte == -1 || (writable && !put_user (p, byte)))
+        return false;
+    }
+  return true;
+}
+
+/* Returns true if the null-terminated string at user address
+   USTR can be read in full. */
+bool
+user_string_ok (const char *ustr)
+{
+  const uint8_t *p = (const uint8_t *) ustr;
+  int byte;
+
+  do
+    {
+      if (!is_user_vaddr (p))
+        return false;
+      byte = get_user (p++);
+      if (byte == -1)
+        return false;
+    }
+  while (byte != '\0');
+  return true;
+}
+
+/* Kills the process unless user_buffer_ok(). */
+static void
+check_user_buffer (const void *uaddr, size_t size, bool writable)
+{
+  if (!user_buffer_ok (uaddr, size, writable))
+    sys_exit (-1);
+}
+
+/* Kills the process unless user_string_ok(). */
+static void
+check_user_string (const char *ustr)
+{
+  if (!user_string_ok (ustr))
+    sys_exit (-1);
+}
+
+/* Keeps the SIZE bytes at user address UADDR in memory while the
+   file system copies between them and its buffer cache.  A page
+   fault in the middle of that copy could evict the very cache
+   block being copied.  Returns true if the buffer was pinned.
+   If no frames can be had, the buffer is left unpinned and a
+   fault during the copy pages it in, as it would have before
+   pinning existed. */
+static bool
+pin_user_buffer (const void *uaddr UNUSED, size_t size UNUSED)
+{
+#ifdef VM
+  return page_pin (uaddr, size);
+#else
+  return false;
+#endif
+}
+
+/* Undoes pin_user_buffer(), which returned true. */
+static void
+unpin_user_buffer (const void *uaddr UNUSED, size_t size UNUSED)
+{
+#ifdef VM
+  page_unpin (uaddr, size);
+#endif
+}
+
 void
 sys_halt(void)
 {
@@ -155,10 +483,8 @@ sys_exit(int status)
 int
 sys_exec(const char *cmd_line)
 {
-  if(!is_valid_usraddr((void *)cmd_line))
-    return -1;
-  else
-    return process_execute(cmd_line);
+  check_user_string(cmd_line);
+  return process_execute(cmd_line);
 }
 
 int
@@ -170,34 +496,24 @@ sys_wait(tid_t pid)
 bool
 sys_create(const char *file, unsigned initial_size)
 {
-  if(file == NULL)
-    sys_exit(-1);
-  if(!is_valid_usraddr((void *)file))
-    sys_exit(-1);  
+  check_user_string(file);
   return filesys_create(file, initial_size);
 }
 
 bool
 sys_remove(const char *file)
 {
-  if(file == NULL)
-    sys_exit(-1);
-  if(!is_valid_usraddr((void *)file))
-    sys_exit(-1);
+  check_user_string(file);
   return filesys_remove(file);  
 }
 int
 sys_open(const char *file)
 {
-  if(file == NULL)
-    sys_exit(-1);
-  if(!is_valid_usraddr((void *)file))
-    sys_exit(-1);
+  check_user_string(file);
     
   int fd;
   struct file * f;
-  struct process * p;
-  p = find_process(thread_current()->tid);
+  struct dir * d = NULL;
 
   f = filesys_open (file);
 
@@ -205,17 +521,15 @@ sys_open(const char *file)
   if(f == NULL){
     fd = -1;
   }
-  //ADD file&fd to current process's file_list
+  //ADD file at the lowest free fd of current process
   else{
-    fd = p->fd_cnt;
-    p->fd_cnt++;
-
-    struct fd_file *fd_and_file;
-    fd_and_file = malloc (sizeof *fd_and_file); 
-
-    fd_and_file->fd = fd;
-    fd_and_file->file = f;
-    list_push_back(&p->file_list, &fd_and_file->elem);
+    if (inode_is_dir (file_get_inode (f)))
+      d = dir_open (inode_reopen (file_get_inode (f)));
+    fd = add_file(f, d);
+    if (fd == -1){
+      dir_close(d);
+      file_close(f);
+    }
   }
   return fd;
 }
@@ -223,13 +537,16 @@ sys_open(const char *file)
 int
 sys_filesize(int fd)
 {
-  struct file *f = find_file(fd)->file;
-  return file_length (f);
+  struct fd_file *fd_file = find_file(fd);
+  if (fd_file == NULL)
+    sys_exit(-1);
+  return file_length (fd_file->file);
 }
 
 int
 sys_read(int fd, const void *buffer, unsigned size)
 {
+  struct fd_file *fd_file;
   struct file *f;
   int result;
 
@@ -237,50 +554,54 @@ sys_read(int fd, const void *buffer, unsigned size)
     sys_exit(-1);
   }
   //CASE 0: buffer's address is NOT available
-  if(!is_valid_usraddr((void *)buffer) || !is_user_vaddr (buffer + size)){
-    sys_exit(-1);
-  }
+  check_user_buffer(buffer, size, true);
   //CASE 0: fd == 1 is write to command
   if (fd == 1){
     sys_exit(-1);
   }
 
-  //Filesys synchronization
-  lock_acquire(&filesys_lock);
-
-  //CASE 1: READ from command
+  //CASE 1: READ from command, without holding up file system users
   if(fd == 0){
     int i;
     for (i = 0; i !=(int)size; i++){
       *(uint8_t *)buffer = input_getc();
       buffer++;
     }
-    lock_release(&filesys_lock);
     return size;
   }
+
+  //Filesys synchronization
+  lock_acquire(&filesys_lock);
+
   //CASE 2: READ from file
-  else{
-    //ERROR: NO FILE!
-    if (find_file(fd) == NULL){
-      lock_release(&filesys_lock);
-      sys_exit(-1);
-    }
-    f = find_file(fd)->file;
-    result = file_read(f, buffer, (off_t) size);
+  //ERROR: NO FILE!
+  fd_file = find_file(fd);
+  if (fd_file == NULL){
     lock_release(&filesys_lock);
+    sys_exit(-1);
   }
+  //ERROR: directories are read with readdir
+  if (fd_file->dir != NULL){
+    lock_release(&filesys_lock);
+    return -1;
+  }
+  f = fd_file->file;
+  bool pinned = pin_user_buffer(buffer, size);
+  result = file_read(f, buffer, (off_t) size);
+  if (pinned)
+    unpin_user_buffer(buffer, size);
+  lock_release(&filesys_lock);
   return result;
 }
 
 int
 sys_write(int fd, const void *buffer, unsigned size)
 {
+  struct fd_file *fd_file;
   struct file *f;
 
   //CASE 0: buffer's address is NOT available
-  if(!is_valid_usraddr((void *)buffer) || !is_user_vaddr (buffer + size)){
-    sys_exit(-1);
-  }
+  check_user_buffer(buffer, size, false);
   //CASE 0: fd == 0 is read to command
   if (fd == 0){
     sys_exit(-1);
@@ -296,13 +617,22 @@ sys_write(int fd, const void *buffer, unsigned size)
   }
   //CASE 2: WRITE to file
   else{
-    if (find_file(fd) == NULL){
+    fd_file = find_file(fd);
+    if (fd_file == NULL){
       lock_release(&filesys_lock);
       sys_exit(-1);
     }
-    
-    f = find_file(fd)->file;
+    //ERROR: directories cannot be written
+    if (fd_file->dir != NULL){
+      lock_release(&filesys_lock);
+      return -1;
+    }
+
+    f = fd_file->file;
+    bool pinned = pin_user_buffer(buffer, size);
     result = file_write(f, buffer, (off_t) size);
+    if (pinned)
+      unpin_user_buffer(buffer, size);
   }
   lock_release(&filesys_lock);
 
@@ -311,6 +641,7 @@ sys_write(int fd, const void *buffer, unsigned size)
 void
 sys_seek(int fd, unsigned position)
 {
+  struct fd_file *fd_file;
   struct file *f;
   //ERROR: NOT FILE(COMMAND)
   if (fd == 0)
@@ -318,10 +649,11 @@ sys_seek(int fd, unsigned position)
   if(fd == 1)
     ASSERT(0);
   //ERROR: CANNOT find file
-  if (find_file(fd) == NULL)
+  fd_file = find_file(fd);
+  if (fd_file == NULL)
     sys_exit(-1);
 
-  f = find_file(fd)->file;  
+  f = fd_file->file;
   file_seek(f, position);
   return;
 }
@@ -329,6 +661,7 @@ sys_seek(int fd, unsigned position)
 unsigned
 sys_tell(int fd)
 {
+  struct fd_file *fd_file;
   struct file *f;
   //ERROR: NOT FILE(COMMAND)
   if (fd == 0)
@@ -336,9 +669,10 @@ sys_tell(int fd)
   if(fd == 1)
     ASSERT(0);
   //ERROR: CANNOT find file
-  if (find_file(fd) == NULL)
+  fd_file = find_file(fd);
+  if (fd_file == NULL)
     sys_exit(-1);
-  f = find_file(fd)->file;
+  f = fd_file->file;
 
   return file_tell(f);
 }
@@ -352,54 +686,476 @@ sys_close(int fd)
   if (fd == 1)
     sys_exit(-1);
   //ERROR: CANNOT find file
-  if (find_file(fd) == NULL){
-    sys_exit(-1);
-  }
-  struct file *f = find_file(fd)->file;
-  
-  //ERROR: FILE is NULL
-  if (f == NULL){
-    list_remove(&find_file(fd)->elem);
-    free(find_file(fd));
+  struct fd_file *fd_file = find_file(fd);
+  if (fd_file == NULL){
     sys_exit(-1);
   }
-  else{
-    file_close (f);
-    list_remove(&find_file(fd)->elem);
-    free(find_file(fd));
-  }
+  file_close (fd_file->file);
+  dir_close (fd_file->dir);
+  remove_file (fd);
 }
 
-
-/*
+/* Changes the current process's working directory to DIR. */
 bool
 sys_chdir (const char *dir)
 {
-  return syscall1 (SYS_CHDIR, dir);
+  struct process *p;
+  struct dir *d;
+
+  check_user_string(dir);
+
+  lock_acquire(&filesys_lock);
+  d = filesys_open_dir(dir);
+  if (d != NULL){
+    p = process_current();
+    inode_close(p->cwd);
+    p->cwd = inode_reopen(dir_get_inode(d));
+    dir_close(d);
+  }
+  lock_release(&filesys_lock);
+  return d != NULL;
 }
 
+/* Creates the directory DIR. */
 bool
 sys_mkdir (const char *dir)
 {
-  return syscall1 (SYS_MKDIR, dir);
+  bool success;
+
+  check_user_string(dir);
+
+  lock_acquire(&filesys_lock);
+  success = filesys_mkdir(dir);
+  lock_release(&filesys_lock);
+  return success;
 }
 
+/* Reads the next entry of directory FD into NAME, which must
+   have room for NAME_MAX + 1 bytes. */
 bool
-sys_readdir (int fd, char name[READDIR_MAX_LEN + 1]) 
+sys_readdir (int fd, char *name)
 {
-  return syscall2 (SYS_READDIR, fd, name);
+  struct fd_file *fd_file = find_file(fd);
+  bool success;
+
+  check_user_buffer(name, NAME_MAX + 1, true);
+  if (fd_file == NULL)
+    sys_exit(-1);
+  if (fd_file->dir == NULL)
+    return false;
+
+  lock_acquire(&filesys_lock);
+  success = dir_readdir(fd_file->dir, name);
+  lock_release(&filesys_lock);
+  return success;
 }
 
+/* Returns true if FD is a directory. */
 bool
 sys_isdir (int fd) 
 {
-  return syscall1 (SYS_ISDIR, fd);
+  struct fd_file *fd_file = find_file(fd);
+
+  if (fd_file == NULL)
+    sys_exit(-1);
+  return fd_file->dir != NULL;
 }
 
+/* Returns the inode number of FD. */
 int
 sys_inumber (int fd) 
 {
-  return syscall1 (SYS_INUMBER, fd);
+  struct fd_file *fd_file = find_file(fd);
+
+  if (fd_file == NULL)
+    sys_exit(-1);
+  return inode_get_inumber(file_get_inode(fd_file->file));
+}
+
+/* Reads as many of the next entries of directory FD as fit in
+   the SIZE bytes at BUFFER, as an array of struct readdir_entry.
+   Returns the number of entries read, 0 at the end of the
+   directory, or -1 if FD is not a directory. */
+int
+sys_readdir_batch (int fd, void *buffer, unsigned size)
+{
+  struct fd_file *fd_file = find_file(fd);
+  int cnt;
+
+  check_user_buffer(buffer, size, true);
+  if (fd_file == NULL)
+    sys_exit(-1);
+  if (fd_file->dir == NULL)
+    return -1;
+
+  lock_acquire(&filesys_lock);
+  cnt = dir_readdir_batch(fd_file->dir, buffer,
+                          size / sizeof (struct readdir_entry));
+  lock_release(&filesys_lock);
+  return cnt;
+}
+
+/* Reads SIZE bytes from FD into BUFFER starting at byte OFFSET of
+   the file, without using or moving the file position.  Returns
+   the number of bytes read, or -1 if FD is not a regular file or
+   the range goes past the largest file offset. */
+int
+sys_pread(int fd, void *buffer, unsigned size, unsigned offset)
+{
+  struct fd_file *fd_file;
+  int result;
+
+  check_user_buffer(buffer, size, true);
+
+  fd_file = find_file(fd);
+  if (fd_file == NULL)
+    return -1;
+  //ERROR: directories are read with readdir
+  if (fd_file->dir != NULL)
+    return -1;
+  //ERROR: the range must fit in an off_t
+  if (offset > INT_MAX || size > INT_MAX - offset)
+    return -1;
+
+  lock_acquire(&filesys_lock);
+  bool pinned = pin_user_buffer(buffer, size);
+  result = file_read_at(fd_file->file, buffer, size, offset);
+  if (pinned)
+    unpin_user_buffer(buffer, size);
+  lock_release(&filesys_lock);
+  return result;
+}
+
+/* Writes SIZE bytes from BUFFER to FD starting at byte OFFSET of
+   the file, without using or moving the file position.  Returns
+   the number of bytes written, or -1 if FD is not a regular
+   file or the range goes past the largest file offset. */
+int
+sys_pwrite(int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  struct fd_file *fd_file;
+  int result;
+
+  check_user_buffer(buffer, size, false);
+
+  fd_file = find_file(fd);
+  if (fd_file == NULL)
+    return -1;
+  //ERROR: directories cannot be written
+  if (fd_file->dir != NULL)
+    return -1;
+  //ERROR: the range must fit in an off_t
+  if (offset > INT_MAX || size > INT_MAX - offset)
+    return -1;
+
+  lock_acquire(&filesys_lock);
+  bool pinned = pin_user_buffer(buffer, size);
+  result = file_write_at(fd_file->file, buffer, size, offset);
+  if (pinned)
+    unpin_user_buffer(buffer, size);
+  lock_release(&filesys_lock);
+  return result;
+}
+
+/* Checks the IOVCNT buffers described by IOV, all of them before
+   any is used, and kills the process if any is bad.  The buffers
+   must be writable if WRITABLE is true.  Returns false if IOVCNT
+   is out of range or the lengths add up to more than INT_MAX,
+   which the byte count returned could not represent. */
+static bool
+validate_iov(const struct iovec *iov, int iovcnt, bool writable)
+{
+  size_t total = 0;
+  int i;
+
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+    return false;
+  check_user_buffer(iov, iovcnt * sizeof *iov, false);
+  for (i = 0; i < iovcnt; i++){
+    if (iov[i].iov_len > INT_MAX - total)
+      return false;
+    total += iov[i].iov_len;
+  }
+  for (i = 0; i < iovcnt; i++)
+    check_user_buffer(iov[i].iov_base, iov[i].iov_len, writable);
+  return true;
+}
+
+/* Reads from FD into the IOVCNT buffers in IOV, filling each in
+   turn, with a single acquisition of the file system lock.
+   Returns the number of bytes read, or -1 on error. */
+int
+sys_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+  struct fd_file *fd_file = NULL;
+  int result = 0;
+  int i;
+
+  if (!validate_iov(iov, iovcnt, true))
+    return -1;
+  //CASE 0: fd == 1 is write to command
+  if (fd == 1)
+    sys_exit(-1);
+  if (fd != 0){
+    fd_file = find_file(fd);
+    if (fd_file == NULL)
+      sys_exit(-1);
+    //ERROR: directories are read with readdir
+    if (fd_file->dir != NULL)
+      return -1;
+  }
+
+  //The console is read without holding up file system users
+  if (fd != 0)
+    lock_acquire(&filesys_lock);
+  for (i = 0; i < iovcnt; i++){
+    uint8_t *buffer = iov[i].iov_base;
+    off_t size = iov[i].iov_len;
+    off_t cnt;
+
+    //CASE 1: READ from command
+    if (fd == 0){
+      for (cnt = 0; cnt < size; cnt++)
+        buffer[cnt] = input_getc();
+    }
+    //CASE 2: READ from file, stopping at end of file
+    else{
+      bool pinned = pin_user_buffer(buffer, size);
+      cnt = file_read(fd_file->file, buffer, size);
+      if (pinned)
+        unpin_user_buffer(buffer, size);
+    }
+    result += cnt;
+    if (cnt < size)
+      break;
+  }
+  if (fd != 0)
+    lock_release(&filesys_lock);
+  return result;
+}
+
+/* Writes the IOVCNT buffers in IOV to FD in order, with a single
+   acquisition of the file system lock.  Returns the number of
+   bytes written, or -1 on error. */
+int
+sys_writev(int fd, const struct iovec *iov, int iovcnt)
+{
+  struct fd_file *fd_file = NULL;
+  int result = 0;
+  int i;
+
+  if (!validate_iov(iov, iovcnt, false))
+    return -1;
+  //CASE 0: fd == 0 is read to command
+  if (fd == 0)
+    sys_exit(-1);
+  if (fd != 1){
+    fd_file = find_file(fd);
+    if (fd_file == NULL)
+      sys_exit(-1);
+    //ERROR: directories cannot be written
+    if (fd_file->dir != NULL)
+      return -1;
+  }
+
+  lock_acquire(&filesys_lock);
+  for (i = 0; i < iovcnt; i++){
+    const void *buffer = iov[i].iov_base;
+    off_t size = iov[i].iov_len;
+    off_t cnt;
+
+    //CASE 1: WRITE to command
+    if (fd == 1){
+      putbuf(buffer, size);
+      cnt = size;
+    }
+    //CASE 2: WRITE to file, stopping if the disk fills up
+    else{
+      bool pinned = pin_user_buffer(buffer, size);
+      cnt = file_write(fd_file->file, buffer, size);
+      if (pinned)
+        unpin_user_buffer(buffer, size);
+    }
+    result += cnt;
+    if (cnt < size)
+      break;
+  }
+  lock_release(&filesys_lock);
+  return result;
+}
+
+/* Copies up to SIZE bytes from FD_IN to FD_OUT, starting at and
+   advancing each file's position, inside the kernel.  Returns
+   the number of bytes copied, which is less than SIZE only at the
+   end of FD_IN, or -1 if either fd is not a regular file or the
+   two ranges overlap within one file. */
+int
+sys_copy_file_range(int fd_in, int fd_out, unsigned size)
+{
+  struct fd_file *in = find_file(fd_in);
+  struct fd_file *out = find_file(fd_out);
+  off_t in_pos, out_pos, len;
+  int result = -1;
+
+  if (in == NULL || out == NULL || in->dir != NULL || out->dir != NULL)
+    return -1;
+
+  lock_acquire(&filesys_lock);
+  in_pos = file_tell(in->file);
+  out_pos = file_tell(out->file);
+
+  //Copy no more than FD_IN has left, nor past the largest off_t
+  len = file_length(in->file) - in_pos;
+  if (len < 0)
+    len = 0;
+  if (size < (unsigned) len)
+    len = size;
+  if (len > INT_MAX - out_pos)
+    len = INT_MAX - out_pos;
+
+  //Refuse ranges that overlap within one file
+  if (file_get_inode(in->file) != file_get_inode(out->file)
+      || (in_pos < out_pos ? out_pos - in_pos : in_pos - out_pos) >= len)
+    result = file_copy(out->file, in->file, len);
+  lock_release(&filesys_lock);
+  return result;
+}
+
+/* Does nothing.  Timing it measures the bare cost of entering
+   and leaving the kernel. */
+void
+sys_null(void)
+{
 }
 
-*/
\ No newline at end of file
+/* Starts reading SIZE bytes at OFFSET in FD into BUFFER and
+   returns a request identifier for aio_wait(), or -1.  SIZE may
+   be at most AIO_MAX_SIZE. */
+int
+sys_aio_read(int fd, void *buffer, unsigned size, unsigned offset)
+{
+  struct fd_file *fd_file;
+
+  //ERROR: too big, or past the largest file offset
+  if (size > AIO_MAX_SIZE || offset > INT_MAX - size)
+    return -1;
+  check_user_buffer(buffer, size, true);
+  fd_file = find_file(fd);
+  if (fd_file == NULL || fd_file->dir != NULL)
+    return -1;
+  return aio_submit(fd_file->file, buffer, size, offset, false);
+}
+
+/* Starts writing SIZE bytes from BUFFER at OFFSET in FD and
+   returns a request identifier for aio_wait(), or -1.  BUFFER
+   may be reused as soon as this returns.  SIZE may be at most
+   AIO_MAX_SIZE. */
+int
+sys_aio_write(int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  struct fd_file *fd_file;
+
+  //ERROR: too big, or past the largest file offset
+  if (size > AIO_MAX_SIZE || offset > INT_MAX - size)
+    return -1;
+  check_user_buffer(buffer, size, false);
+  fd_file = find_file(fd);
+  if (fd_file == NULL || fd_file->dir != NULL)
+    return -1;
+  return aio_submit(fd_file->file, (void *) buffer, size, offset, true);
+}
+
+/* Sets the revents member of each of the NFDS entries in FDS and
+   returns how many are nonzero.  The console is readable once a
+   key is waiting and always writable.  Files and directories
+   never block, so they are always ready. */
+static int
+poll_scan(struct pollfd *fds, unsigned nfds)
+{
+  enum intr_level old_level;
+  unsigned i;
+  int cnt = 0;
+
+  for (i = 0; i < nfds; i++){
+    struct pollfd *p = &fds[i];
+    short ready;
+
+    if (p->fd == 0){
+      old_level = intr_disable();
+      ready = input_empty() ? 0 : POLLIN;
+      intr_set_level(old_level);
+    }
+    else if (p->fd == 1)
+      ready = POLLOUT;
+    else if (find_file(p->fd) != NULL)
+      ready = POLLIN | POLLOUT;
+    else
+      ready = POLLNVAL;
+
+    p->revents = ready & (p->events | POLLNVAL);
+    if (p->revents != 0)
+      cnt++;
+  }
+  return cnt;
+}
+
+/* Waits until at least one of the NFDS file descriptors in FDS
+   is ready for the events it asks for, or for TIMEOUT
+   milliseconds if TIMEOUT is nonnegative.  Returns the number of
+   ready descriptors, setting each one's revents. */
+int
+sys_poll(struct pollfd *fds, unsigned nfds, int timeout)
+{
+  int64_t deadline = -1;
+  int cnt;
+
+  if (timeout >= 0)
+    deadline = timer_ticks() + ((int64_t) timeout * TIMER_FREQ + 999) / 1000;
+  if (nfds > (unsigned) PGSIZE)
+    sys_exit(-1);
+  check_user_buffer(fds, nfds * sizeof *fds, true);
+
+  for (;;){
+    unsigned stamp = input_stamp();
+    //The ring worker may change the descriptor table, but not while we look
+    bool ring_locked = ring_acquire();
+
+    cnt = poll_scan(fds, nfds);
+    if (ring_locked)
+      ring_release();
+    //Only console input can change what we saw, so sleep until a key comes
+    if (cnt != 0 || !input_wait_since(stamp, deadline))
+      break;
+  }
+  return cnt;
+}
+
+#ifdef VM
+/* Maps the file open as FD into memory at ADDR.  Returns the
+   mapping's identifier, or -1 if FD is not a regular file or the
+   file cannot be mapped there. */
+int
+sys_mmap(int fd, void *addr)
+{
+  struct fd_file *fd_file = find_file(fd);
+
+  if (fd_file == NULL || fd_file->dir != NULL)
+    return -1;
+  return mmap_map(fd_file->file, addr);
+}
+
+/* Unmaps the mapping MAPID made by mmap. */
+void
+sys_munmap(int mapid)
+{
+  mmap_unmap(mapid);
+}
+
+/* Copies the current process's paging counters into USAGE. */
+void
+sys_getrusage(struct rusage *usage)
+{
+  check_user_buffer(usage, sizeof *usage, true);
+  memcpy(usage, &process_current()->usage, sizeof *usage);
+}
+#endif
@@ -3,9 +3,12 @@
 #include <stdint.h>
 #include <stdio.h>
 #include "threads/thread.h"
+#include <syscall-nr.h>
 
 void syscall_init (void);
-void syscall_arguments(uint32_t **, uint32_t *, int);
+void syscall_arguments(uint32_t *, uint32_t *, int);
+bool user_buffer_ok (const void *, size_t, bool writable);
+bool user_string_ok (const char *);
 void sys_halt (void);
 void sys_exit (int);
 int sys_exec(const char *);
@@ -19,8 +22,28 @@ int sys_write(int, const void *, unsigned);
 void sys_seek(int, unsigned);
 unsigned sys_tell(int);
 void sys_close(int);
+bool sys_chdir(const char *);
+bool sys_mkdir(const char *);
+bool sys_readdir(int, char *);
+bool sys_isdir(int);
+int sys_inumber(int);
+int sys_readdir_batch(int, void *, unsigned);
+int sys_pread(int, void *, unsigned, unsigned);
+int sys_pwrite(int, const void *, unsigned, unsigned);
+int sys_readv(int, const struct iovec *, int);
+int sys_writev(int, const struct iovec *, int);
+int sys_copy_file_range(int, int, unsigned);
+void sys_null(void);
+int sys_aio_read(int, void *, unsigned, unsigned);
+int sys_aio_write(int, const void *, unsigned, unsigned);
+int sys_poll(struct pollfd *, unsigned, int);
+#ifdef VM
+int sys_mmap(int, void *);
+void sys_munmap(int);
+void sys_getrusage(struct rusage *);
+#endif
 
-struct lock filesys_lock;
+extern struct lock filesys_lock;
 
 #endif /* userprog/syscall.h */
 
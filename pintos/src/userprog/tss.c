@@ -104,3 +104,13 @@ tss_update (void)
   ASSERT (tss != NULL);
   tss->esp0 = (uint8_t *) thread_current () + PGSIZE;
 }
+
+/* Returns the address of the ring 0 stack pointer in the TSS.
+   The sysenter entry stub loads its stack from here, so it
+   always follows tss_update(). */
+void **
+tss_esp0_addr (void)
+{
+  ASSERT (tss != NULL);
+  return &tss->esp0;
+}
@@ -0,0 +1,210 @@
+#include "vm/frame.h"
+#include <debug.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "userprog/pagedir.h"
+#include "vm/page.h"
+#include "vm/swap.h"
+
+/* All frames holding user pages.  The caller of every function
+   here holds the paging lock in vm/page.c. */
+static struct list frame_list;
+
+/* Next frame for the clock algorithm to examine, or the list
+   tail to start over from the beginning. */
+static struct list_elem *clock_hand;
+
+/* Shared frames, keyed by inode and offset. */
+static struct hash shared_frames;
+
+static hash_hash_func frame_hash;
+static hash_less_func frame_less;
+static struct frame *frame_evict (void);
+static bool frame_accessed (struct frame *);
+static void frame_unshare (struct frame *);
+
+/* Initializes the frame table. */
+void
+frame_init (void)
+{
+  list_init (&frame_list);
+  clock_hand = list_end (&frame_list);
+  hash_init (&shared_frames, frame_hash, frame_less, NULL);
+}
+
+/* Returns a private frame to hold PAGE, with one pin so that it
+   cannot be evicted before PAGE is installed in it.  Takes a free page
+   from the user pool if there is one, otherwise evicts another
+   page.  Returns a null pointer if nothing can be evicted. */
+struct frame *
+frame_alloc (struct page *page)
+{
+  void *kpage = palloc_get_page (PAL_USER);
+  struct frame *f;
+
+  if (kpage != NULL)
+    {
+      f = malloc (sizeof *f);
+      if (f == NULL)
+        {
+          palloc_free_page (kpage);
+          return NULL;
+        }
+      f->kpage = kpage;
+      list_init (&f->pages);
+      f->inode = NULL;
+      list_push_back (&frame_list, &f->elem);
+    }
+  else
+    {
+      f = frame_evict ();
+      if (f == NULL)
+        return NULL;
+    }
+  list_push_back (&f->pages, &page->frame_elem);
+  f->pin_cnt = 1;
+  return f;
+}
+
+/* Returns F, which no page may still hold, to the user pool. */
+void
+frame_free (struct frame *f)
+{
+  ASSERT (list_empty (&f->pages));
+
+  frame_unshare (f);
+  if (clock_hand == &f->elem)
+    clock_hand = list_next (clock_hand);
+  list_remove (&f->elem);
+  palloc_free_page (f->kpage);
+  free (f);
+}
+
+/* Returns the shared frame caching the page at offset OFS in
+   INODE for writable mappings if WRITABLE, otherwise for
+   read-only text, or a null pointer if there is none. */
+struct frame *
+frame_lookup (struct inode *inode, off_t ofs, bool writable)
+{
+  struct frame key;
+  struct hash_elem *e;
+
+  key.inode = inode;
+  key.ofs = ofs;
+  key.writable = writable;
+  e = hash_find (&shared_frames, &key.share_elem);
+  return e != NULL ? hash_entry (e, struct frame, share_elem) : NULL;
+}
+
+/* Makes F, freshly filled from offset OFS in INODE, the shared
+   frame for that page of INODE for writable mappings if
+   WRITABLE, otherwise for read-only text. */
+void
+frame_share (struct frame *f, struct inode *inode, off_t ofs, bool writable)
+{
+  ASSERT (f->inode == NULL);
+
+  f->inode = inode;
+  f->ofs = ofs;
+  f->writable = writable;
+  hash_insert (&shared_frames, &f->share_elem);
+}
+
+/* Chooses up to SWAP_CLUSTER unpinned frames whose pages have not
+   been accessed since the clock hand last passed them and evicts
+   them together, so that pages going to swap are written out in
+   one batch.  Returns one of the frames empty and gives the rest
+   back to the user pool for the allocations that will follow.
+   Looks no further than two trips around the clock. */
+static struct frame *
+frame_evict (void)
+{
+  struct frame *victims[SWAP_CLUSTER];
+  size_t i, n = list_size (&frame_list);
+  size_t cnt = 0, evicted;
+
+  for (i = 0; i < 2 * n && cnt < SWAP_CLUSTER; i++)
+    {
+      struct frame *f;
+
+      if (clock_hand == list_end (&frame_list))
+        clock_hand = list_begin (&frame_list);
+      f = list_entry (clock_hand, struct frame, elem);
+      clock_hand = list_next (clock_hand);
+
+      if (f->pin_cnt == 0 && !frame_accessed (f))
+        {
+          /* Pin it so that the second trip skips it. */
+          f->pin_cnt++;
+          victims[cnt++] = f;
+        }
+    }
+  if (cnt == 0)
+    return NULL;
+
+  evicted = page_evict (victims, cnt);
+  for (i = 0; i < cnt; i++)
+    {
+      victims[i]->pin_cnt--;
+      if (i < evicted)
+        frame_unshare (victims[i]);
+      if (i > 0 && i < evicted)
+        frame_free (victims[i]);
+    }
+  return evicted > 0 ? victims[0] : NULL;
+}
+
+/* Returns true if any page held in F has been accessed since the
+   last call, clearing their accessed bits. */
+static bool
+frame_accessed (struct frame *f)
+{
+  struct list_elem *e;
+  bool accessed = false;
+
+  for (e = list_begin (&f->pages); e != list_end (&f->pages);
+       e = list_next (e))
+    {
+      struct page *page = list_entry (e, struct page, frame_elem);
+      if (pagedir_is_accessed (page->pagedir, page->upage))
+        {
+          pagedir_set_accessed (page->pagedir, page->upage, false);
+          accessed = true;
+        }
+    }
+  return accessed;
+}
+
+/* Removes F from shared_frames, if it is there. */
+static void
+frame_unshare (struct frame *f)
+{
+  if (f->inode != NULL)
+    {
+      hash_delete (&shared_frames, &f->share_elem);
+      f->inode = NULL;
+    }
+}
+
+/* Returns a hash value for shared frame E. */
+static unsigned
+frame_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct frame *f = hash_entry (e, struct frame, share_elem);
+  return (hash_bytes (&f->inode, sizeof f->inode) ^ hash_int (f->ofs)
+          ^ f->writable);
+}
+
+/* Returns true if shared frame A precedes shared frame B. */
+static bool
+frame_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED)
+{
+  const struct frame *a = hash_entry (a_, struct frame, share_elem);
+  const struct frame *b = hash_entry (b_, struct frame, share_elem);
+  if (a->inode != b->inode)
+    return a->inode < b->inode;
+  if (a->ofs != b->ofs)
+    return a->ofs < b->ofs;
+  return a->writable < b->writable;
+}
@@ -0,0 +1,45 @@
+#ifndef VM_FRAME_H
+#define VM_FRAME_H
+
+#include <hash.h>
+#include <list.h>
+#include <stdbool.h>
+#include "filesys/off_t.h"
+
+struct inode;
+struct page;
+
+/* A physical frame from the user pool holding a user page.
+
+   Most frames hold one process's private page.  A frame caching
+   a page of a file, as mapped by mmap() or as read-only text of
+   an executable, may be shared by every page that maps the same
+   place in that file the same way; INODE, OFS, and WRITABLE then
+   identify it.  Writable mappings and read-only text never share
+   a frame, so that writes through a mapping cannot change the
+   code of a running program.  The frame is freed when the last
+   page in PAGES lets go of it.
+
+   Each holder of a pin on the frame, such as a fault bringing it
+   in or a system call copying to it, counts in PIN_CNT and takes
+   its own pin back, so that one does not release another's. */
+struct frame
+  {
+    struct list_elem elem;      /* Element in frame_list. */
+    void *kpage;                /* Kernel virtual address. */
+    struct list pages;          /* Pages held in this frame. */
+    unsigned pin_cnt;           /* Exempt from eviction if nonzero. */
+
+    struct hash_elem share_elem; /* Element in shared_frames. */
+    struct inode *inode;        /* File cached here, or NULL if private. */
+    off_t ofs;                  /* Offset of the page in INODE. */
+    bool writable;              /* Mapped writable rather than text? */
+  };
+
+void frame_init (void);
+struct frame *frame_alloc (struct page *);
+void frame_free (struct frame *);
+struct frame *frame_lookup (struct inode *, off_t ofs, bool writable);
+void frame_share (struct frame *, struct inode *, off_t ofs, bool writable);
+
+#endif /* vm/frame.h */
@@ -0,0 +1,146 @@
+#include "vm/mmap.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include "filesys/file.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#include "vm/page.h"
+
+/* A file mapped into a process's address space by mmap(). */
+struct mapping
+  {
+    struct list_elem elem;      /* Element in the process's mappings. */
+    int id;                     /* Mapping identifier. */
+    struct file *file;          /* The file mapped, reopened. */
+    uint8_t *addr;              /* Address of the first page. */
+    size_t page_cnt;            /* Number of pages mapped. */
+  };
+
+static struct mapping *mmap_find (struct process *, int mapid);
+static void mmap_free (struct mapping *);
+
+/* Maps all of FILE into the current process's address space
+   starting at ADDR, and returns the new mapping's identifier.
+   Pages are read from the file on first touch and written back
+   when unmapped, if they were written.  Mappings of the same part
+   of a file, in any process, share memory.  Returns -1 if ADDR
+   is not page-aligned, FILE is empty or denies writes, as a
+   running executable does, or any page in the range is already
+   in use. */
+int
+mmap_map (struct file *file, void *addr_)
+{
+  struct process *p = process_current ();
+  uint8_t *addr = addr_;
+  struct mapping *m;
+  off_t length;
+  bool denied;
+  size_t page_cnt, i;
+
+  if (addr == NULL || pg_ofs (addr) != 0 || !is_user_vaddr (addr))
+    return -1;
+  m = malloc (sizeof *m);
+  if (m == NULL)
+    return -1;
+
+  /* Reopen FILE, so that the mapping outlives its descriptor. */
+  lock_acquire (&filesys_lock);
+  m->file = file_reopen (file);
+  length = m->file != NULL ? file_length (m->file) : 0;
+  denied = (m->file != NULL
+            && inode_is_write_denied (file_get_inode (m->file)));
+  lock_release (&filesys_lock);
+  m->addr = addr;
+  m->page_cnt = 0;
+  if (length == 0 || denied
+      || (size_t) length > (size_t) ((uint8_t *) PHYS_BASE - addr))
+    {
+      mmap_free (m);
+      return -1;
+    }
+
+  page_cnt = DIV_ROUND_UP ((size_t) length, PGSIZE);
+  for (i = 0; i < page_cnt; i++)
+    {
+      off_t ofs = i * PGSIZE;
+      size_t read_bytes = length - ofs < PGSIZE ? length - ofs : PGSIZE;
+
+      if (!page_add (addr + ofs, m->file, ofs, read_bytes, true, true))
+        {
+          mmap_free (m);
+          return -1;
+        }
+      m->page_cnt++;
+    }
+
+  m->id = p->next_mapid++;
+  list_push_back (&p->mappings, &m->elem);
+  return m->id;
+}
+
+/* Unmaps the current process's mapping MAPID, writing back the
+   pages written through it.  Does nothing if there is no such
+   mapping. */
+void
+mmap_unmap (int mapid)
+{
+  struct mapping *m = mmap_find (process_current (), mapid);
+
+  if (m != NULL)
+    {
+      list_remove (&m->elem);
+      mmap_free (m);
+    }
+}
+
+/* Unmaps all of P's mappings.  P must be the current process. */
+void
+mmap_release (struct process *p)
+{
+  while (!list_empty (&p->mappings))
+    {
+      struct list_elem *e = list_pop_front (&p->mappings);
+      mmap_free (list_entry (e, struct mapping, elem));
+    }
+}
+
+/* Returns P's mapping MAPID, or a null pointer if it has none. */
+static struct mapping *
+mmap_find (struct process *p, int mapid)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&p->mappings); e != list_end (&p->mappings);
+       e = list_next (e))
+    {
+      struct mapping *m = list_entry (e, struct mapping, elem);
+      if (m->id == mapid)
+        return m;
+    }
+  return NULL;
+}
+
+/* Removes M's pages, closes its file, and frees M. */
+static void
+mmap_free (struct mapping *m)
+{
+  bool fs;
+  size_t i;
+
+  for (i = 0; i < m->page_cnt; i++)
+    page_remove (m->addr + i * PGSIZE);
+
+  fs = !lock_held_by_current_thread (&filesys_lock);
+  if (fs)
+    lock_acquire (&filesys_lock);
+  file_close (m->file);
+  if (fs)
+    lock_release (&filesys_lock);
+  free (m);
+}
@@ -0,0 +1,11 @@
+#ifndef VM_MMAP_H
+#define VM_MMAP_H
+
+struct file;
+struct process;
+
+int mmap_map (struct file *, void *addr);
+void mmap_unmap (int mapid);
+void mmap_release (struct process *);
+
+#endif /* vm/mmap.h */
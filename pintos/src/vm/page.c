@@ -0,0 +1,775 @@
+#include "vm/page.h"
+#include <debug.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#include "vm/frame.h"
+#include "vm/swap.h"
+
+/* Maximum size of a user stack, in pages.  The default allows
+   8 MB; the -sl=COUNT kernel option overrides it. */
+size_t stack_page_limit = 2048;
+
+/* Most pages mapped ahead of a single fault. */
+#define FAULT_AROUND_MAX 16
+
+/* Fault-around takes at most 1/FAULT_AROUND_SHARE of the free
+   user pool for new frames. */
+#define FAULT_AROUND_SHARE 4
+
+/* A page of zeros, mapped read-only in place of every zero-fill
+   page that has been read but not yet written. */
+static void *zero_kpage;
+
+/* Serializes paging: bringing pages in, evicting them, freeing
+   them, and the frame table.  Whoever needs both this and
+   filesys_lock acquires filesys_lock first. */
+static struct lock page_lock;
+
+static hash_hash_func page_hash;
+static hash_less_func page_less;
+static hash_action_func page_free;
+static struct page *page_lookup (struct process *, const void *upage);
+static bool page_in (struct page *, bool write);
+static size_t page_swap_in_run (struct process *, struct page *);
+static bool page_is_zero_mapped (struct page *);
+static struct frame *page_shared_frame (struct page *);
+static bool page_reads_disk (struct page *);
+static void page_set_frame (struct page *, struct frame *);
+static void page_charge_io (int64_t start);
+static void page_fault_around (struct process *, uint8_t *upage,
+                               bool write, bool swapped, size_t first);
+static struct fault_stream *fault_stream_find (struct process *,
+                                               uint8_t *upage);
+static void page_write_back (struct page *);
+static bool page_acquire (void);
+static void page_release (bool);
+
+/* Initializes paging. */
+void
+page_init (void)
+{
+  lock_init (&page_lock);
+  zero_kpage = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+}
+
+/* Initializes PAGES as an empty supplemental page table. */
+void
+page_table_init (struct hash *pages)
+{
+  hash_init (pages, page_hash, page_less, NULL);
+}
+
+/* Frees every page of P, which must be the current process,
+   along with its frame or swap slot, and unmaps the pages from
+   P's page directory. */
+void
+page_table_destroy (struct process *p)
+{
+  bool fs = page_acquire ();
+  hash_destroy (&p->pages, page_free);
+  page_release (fs);
+}
+
+/* Records that user page UPAGE of the current process, which
+   must not already be recorded, is initialized on first touch
+   with READ_BYTES bytes from FILE at offset OFS followed by
+   zeros.  FILE may be null if READ_BYTES is 0.  FILE must stay
+   open for as long as the page exists.  Returns false if memory
+   is exhausted or UPAGE is already recorded.
+
+   If SHARED, the page maps that part of FILE itself: it shares a
+   frame with every other shared page of the same file and
+   offset, and what is written to it goes back to the first
+   READ_BYTES bytes at OFS in FILE rather than to swap. */
+bool
+page_add (void *upage, struct file *file, off_t ofs, size_t read_bytes,
+          bool writable, bool shared)
+{
+  struct process *p = process_current ();
+  struct page *page;
+
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (read_bytes <= PGSIZE);
+
+  page = malloc (sizeof *page);
+  if (page == NULL)
+    return false;
+  page->upage = upage;
+  page->pagedir = thread_current ()->pagedir;
+  page->process = p;
+  page->writable = writable;
+  page->shared = shared;
+  page->frame = NULL;
+  page->swap_slot = SWAP_NONE;
+  page->file = read_bytes > 0 || shared ? file : NULL;
+  page->ofs = ofs;
+  page->read_bytes = read_bytes;
+  if (hash_insert (&p->pages, &page->elem) != NULL)
+    {
+      free (page);
+      return false;
+    }
+  return true;
+}
+
+/* Removes the current process's page at UPAGE, if there is one,
+   writing it back to its file if it is shared and was written. */
+void
+page_remove (void *upage)
+{
+  struct process *p = process_current ();
+  struct page *page;
+  bool fs;
+
+  fs = page_acquire ();
+  page = page_lookup (p, upage);
+  if (page != NULL)
+    {
+      hash_delete (&p->pages, &page->elem);
+      page_free (&page->elem, NULL);
+    }
+  page_release (fs);
+}
+
+/* Makes the current process's page containing user address ADDR
+   accessible for reading, or for writing if WRITE, bringing it
+   into memory if it is not there already.  A zero-fill page that
+   is only read maps the shared zero page; the first write gives
+   it a frame of its own.  Returns false if ADDR is not in a
+   recorded page, WRITE is true and the page is read-only, or no
+   frame can be had.  Counts a major fault in P's usage if that
+   meant reading the disk, otherwise a minor one.  A page swapped
+   out to disk is read together with the run of following pages
+   in the following swap slots. */
+bool
+page_load (void *addr, bool write)
+{
+  struct process *p = process_current ();
+  struct page *page;
+  size_t cnt;
+  bool swapped, major;
+  bool fs, success = false;
+
+  if (p == NULL || thread_current ()->pagedir == NULL)
+    return false;
+
+  fs = page_acquire ();
+  page = page_lookup (p, pg_round_down (addr));
+  if (page == NULL || (write && !page->writable))
+    success = false;
+  else if (page->frame != NULL)
+    {
+      /* Swap read-ahead may have left the page unmapped. */
+      success = (pagedir_get_page (page->pagedir, page->upage) != NULL
+                 || pagedir_set_page (page->pagedir, page->upage,
+                                      page->frame->kpage, page->writable));
+    }
+  else if (!write && page_is_zero_mapped (page))
+    success = true;
+  else
+    {
+      swapped = page->swap_slot != SWAP_NONE;
+      major = page_reads_disk (page);
+      if (swap_on_disk (page->swap_slot))
+        cnt = page_swap_in_run (p, page);
+      else
+        cnt = page_in (page, write) ? 1 : 0;
+      if (cnt > 0)
+        {
+          if (page->frame != NULL)
+            page->frame->pin_cnt--;
+          if (major)
+            p->usage.majflt++;
+          else
+            p->usage.minflt++;
+          page_fault_around (p, page->upage, write, swapped, cnt);
+          success = true;
+        }
+    }
+  page_release (fs);
+  return success;
+}
+
+/* Grows the current process's stack down to the page containing
+   user address ADDR, which faulted, if ADDR looks like a stack
+   access given user stack pointer ESP and stays within
+   stack_page_limit pages of PHYS_BASE.  PUSHA writes as far as
+   32 bytes below ESP before moving it, so such accesses count
+   too.  Returns true if the page now exists. */
+bool
+page_grow_stack (void *addr, const void *esp)
+{
+  uint8_t *upage = pg_round_down (addr);
+
+  if (esp == NULL || !is_user_vaddr (addr)
+      || (uint8_t *) addr + 32 < (const uint8_t *) esp
+      || (size_t) ((uint8_t *) PHYS_BASE - upage) / PGSIZE > stack_page_limit)
+    return false;
+  return (page_add (upage, NULL, 0, 0, true, false)
+          && page_load (addr, true));
+}
+
+/* Brings in the current process's pages spanning SIZE bytes at
+   user address ADDR and keeps them from being evicted until
+   page_unpin().  The file system copies to and from its buffer
+   cache with no way to recover from a page fault midway, so
+   system calls pin user buffers before passing them in.  Each
+   call adds a pin to the frames, which page_unpin() takes back.
+   Returns false, leaving nothing pinned, if some page is not
+   recorded or no frame can be had for it. */
+bool
+page_pin (const void *addr, size_t size)
+{
+  struct process *p = process_current ();
+  const uint8_t *start = pg_round_down (addr);
+  const uint8_t *end = (const uint8_t *) addr + size;
+  const uint8_t *upage;
+  bool fs;
+
+  if (size == 0)
+    return true;
+  fs = page_acquire ();
+  for (upage = start; upage < end; upage += PGSIZE)
+    {
+      struct page *page = page_lookup (p, upage);
+      if (page == NULL)
+        break;
+      if (page->frame != NULL)
+        page->frame->pin_cnt++;
+      else if (!page_in (page, true))
+        break;
+    }
+  if (upage < end)
+    {
+      /* Undo the pins taken so far. */
+      for (; start < upage; start += PGSIZE)
+        page_lookup (p, start)->frame->pin_cnt--;
+    }
+  page_release (fs);
+  return upage >= end;
+}
+
+/* Takes back the pins added by page_pin() with the same
+   arguments, which returned true.  The pages may be evicted again
+   once nothing else pins them. */
+void
+page_unpin (const void *addr, size_t size)
+{
+  struct process *p = process_current ();
+  const uint8_t *upage = pg_round_down (addr);
+  const uint8_t *end = (const uint8_t *) addr + size;
+  bool fs;
+
+  if (size == 0)
+    return;
+  fs = page_acquire ();
+  for (; upage < end; upage += PGSIZE)
+    {
+      struct page *page = page_lookup (p, upage);
+      if (page != NULL && page->frame != NULL)
+        {
+          ASSERT (page->frame->pin_cnt > 0);
+          page->frame->pin_cnt--;
+        }
+    }
+  page_release (fs);
+}
+
+/* Returns true if private page A should be swapped out ahead of
+   private page B: that is, if A belongs to an earlier process or
+   to the same process at a lower address. */
+static bool
+swap_order_less (const struct page *a, const struct page *b)
+{
+  if (a->pagedir != b->pagedir)
+    return a->pagedir < b->pagedir;
+  return a->upage < b->upage;
+}
+
+/* Removes every page held in the CNT frames in FRAMES, at most
+   SWAP_CLUSTER of them, which the caller will reuse.  A shared
+   page is written back to its file if any of the pages mapping
+   it was written.  Private pages that may differ from what their
+   files would give are swapped out together, in order of process
+   and address so that neighbouring pages land in neighbouring
+   swap slots; clean ones are simply dropped.  Returns the number
+   of frames emptied and moves them to the front of FRAMES.  A
+   frame stays as it was if swap has no room for its page.  The
+   caller holds the paging lock. */
+size_t
+page_evict (struct frame *frames[], size_t cnt)
+{
+  const void *kpages[SWAP_CLUSTER];
+  struct page *swapped[SWAP_CLUSTER];   /* Pages to swap out, sorted. */
+  size_t owner[SWAP_CLUSTER];           /* Index in FRAMES of each. */
+  bool dirty[SWAP_CLUSTER];             /* Dirty bit of each. */
+  size_t slots[SWAP_CLUSTER];
+  bool kept[SWAP_CLUSTER];              /* Frames not evicted. */
+  size_t swap_cnt = 0;
+  size_t evicted = 0;
+  int64_t start;
+  size_t i, j;
+
+  ASSERT (cnt <= SWAP_CLUSTER);
+
+  for (i = 0; i < cnt; i++)
+    {
+      struct frame *f = frames[i];
+      struct page *page = list_entry (list_front (&f->pages),
+                                      struct page, frame_elem);
+      struct list_elem *e;
+      bool written = false;
+
+      kept[i] = false;
+
+      /* Unmap first, so that the owners fault and wait for the
+         paging lock if they touch the page meanwhile.  Only then
+         is the dirty bit, which the cleared entry keeps, final. */
+      for (e = list_begin (&f->pages); e != list_end (&f->pages);
+           e = list_next (e))
+        {
+          struct page *p = list_entry (e, struct page, frame_elem);
+          pagedir_clear_page (p->pagedir, p->upage);
+          if (pagedir_is_dirty (p->pagedir, p->upage))
+            written = true;
+        }
+
+      if (page->shared)
+        {
+          if (written)
+            page_write_back (page);
+        }
+      else if (page->file == NULL || written)
+        {
+          /* A private frame holds just this one page.  Insert it
+             in order. */
+          for (j = swap_cnt; j > 0 && swap_order_less (page, swapped[j - 1]);
+               j--)
+            {
+              swapped[j] = swapped[j - 1];
+              owner[j] = owner[j - 1];
+              dirty[j] = dirty[j - 1];
+            }
+          swapped[j] = page;
+          owner[j] = i;
+          dirty[j] = written;
+          swap_cnt++;
+        }
+    }
+
+  for (i = 0; i < swap_cnt; i++)
+    kpages[i] = swapped[i]->frame->kpage;
+  start = timer_ticks ();
+  swap_out_multiple (kpages, swap_cnt, slots);
+  page_charge_io (start);
+  for (i = 0; i < swap_cnt; i++)
+    {
+      struct page *page = swapped[i];
+      if (slots[i] == SWAP_NONE)
+        {
+          pagedir_set_page (page->pagedir, page->upage, page->frame->kpage,
+                            page->writable);
+          pagedir_set_dirty (page->pagedir, page->upage, dirty[i]);
+          kept[owner[i]] = true;
+        }
+      else
+        {
+          page->swap_slot = slots[i];
+          page->file = NULL;
+          page->process->usage.nswapout++;
+        }
+    }
+
+  for (i = 0; i < cnt; i++)
+    {
+      struct frame *f = frames[i];
+
+      if (kept[i])
+        continue;
+      while (!list_empty (&f->pages))
+        {
+          struct list_elem *e = list_pop_front (&f->pages);
+          page_set_frame (list_entry (e, struct page, frame_elem), NULL);
+        }
+      frames[i] = frames[evicted];
+      frames[evicted++] = f;
+    }
+  return evicted;
+}
+
+/* Gives PAGE a frame, fills it, and maps it.  A shared page joins
+   the frame already caching its part of the file, if any, and
+   otherwise becomes the frame to join.  Adds a pin to the frame,
+   which the caller takes back.  Unless WRITE, a zero-fill page
+   instead maps the zero page and gets no frame.  The caller
+   holds the paging lock and filesys_lock. */
+static bool
+page_in (struct page *page, bool write)
+{
+  struct frame *f = page_shared_frame (page);
+  int64_t start;
+
+  if (f != NULL)
+    {
+      if (!pagedir_set_page (page->pagedir, page->upage, f->kpage,
+                             page->writable))
+        return false;
+      list_push_back (&f->pages, &page->frame_elem);
+      f->pin_cnt++;
+      page_set_frame (page, f);
+      return true;
+    }
+
+  if (page->file == NULL && page->swap_slot == SWAP_NONE)
+    {
+      if (!write)
+        return pagedir_set_page (page->pagedir, page->upage, zero_kpage,
+                                 false);
+
+      /* Replace the zero page, if it is mapped. */
+      pagedir_clear_page (page->pagedir, page->upage);
+    }
+
+  f = frame_alloc (page);
+  if (f == NULL)
+    return false;
+
+  start = timer_ticks ();
+  if (page->swap_slot != SWAP_NONE)
+    {
+      swap_in (page->swap_slot, f->kpage);
+      page->swap_slot = SWAP_NONE;
+      page->process->usage.nswapin++;
+    }
+  else if (page->file != NULL
+           && file_read_at (page->file, f->kpage, page->read_bytes, page->ofs)
+              != (off_t) page->read_bytes)
+    {
+      page_charge_io (start);
+      goto error;
+    }
+  else
+    memset ((uint8_t *) f->kpage + page->read_bytes, 0,
+            PGSIZE - page->read_bytes);
+  page_charge_io (start);
+
+  if (!pagedir_set_page (page->pagedir, page->upage, f->kpage,
+                         page->writable))
+    goto error;
+  if (page->shared
+      && frame_lookup (file_get_inode (page->file), page->ofs,
+                       page->writable) == NULL)
+    frame_share (f, file_get_inode (page->file), page->ofs, page->writable);
+  page_set_frame (page, f);
+  return true;
+
+ error:
+  list_remove (&page->frame_elem);
+  frame_free (f);
+  return false;
+}
+
+/* Brings in PAGE, a page of P whose contents are in a swap slot
+   on disk, along with the run of P's following pages whose
+   contents are in the following slots, up to SWAP_CLUSTER pages
+   in all.  Reads them with a single disk command.  PAGE's frame
+   may come from eviction, which frees a cluster of frames; the
+   other pages only use free frames, such as those, so that
+   reading ahead never evicts anything.  Returns the number of
+   pages brought in, or 0 if no frame can be had for PAGE.  PAGE's
+   frame gets a pin, which the caller takes back.  A page that
+   cannot be mapped keeps its frame and is mapped by page_load()
+   when it faults.  The caller holds the paging lock. */
+static size_t
+page_swap_in_run (struct process *p, struct page *page)
+{
+  struct page *pages[SWAP_CLUSTER];
+  struct frame *frames[SWAP_CLUSTER];
+  void *kpages[SWAP_CLUSTER];
+  size_t slot = page->swap_slot;
+  size_t cnt, i;
+  int64_t start;
+
+  for (cnt = 0; cnt < SWAP_CLUSTER; cnt++)
+    {
+      struct page *next = page;
+
+      if (cnt > 0)
+        {
+          next = page_lookup (p, page->upage + cnt * PGSIZE);
+          if (next == NULL || next->swap_slot != slot + cnt
+              || palloc_free_cnt (PAL_USER) == 0)
+            break;
+        }
+      frames[cnt] = frame_alloc (next);
+      if (frames[cnt] == NULL)
+        break;
+      pages[cnt] = next;
+      kpages[cnt] = frames[cnt]->kpage;
+    }
+  if (cnt == 0)
+    return 0;
+
+  start = timer_ticks ();
+  swap_in_run (slot, kpages, cnt);
+  page_charge_io (start);
+  for (i = 0; i < cnt; i++)
+    {
+      struct page *next = pages[i];
+
+      next->swap_slot = SWAP_NONE;
+      p->usage.nswapin++;
+      pagedir_set_page (next->pagedir, next->upage, kpages[i],
+                        next->writable);
+      page_set_frame (next, frames[i]);
+      if (i > 0)
+        frames[i]->pin_cnt--;
+    }
+  return cnt;
+}
+
+/* Maps pages following UPAGE, which P just faulted in for writing
+   if WRITE, from swap if SWAPPED, so that touching them will not
+   fault.  The fault already brought in the FIRST pages starting
+   at UPAGE.  A fault that continues one of P's streams of
+   sequential faults doubles that stream's window, up to
+   FAULT_AROUND_MAX pages; any other starts a new stream with a
+   window of one page.  A page that came from swap always brings
+   its swapped-out neighbours, up to a cluster's worth.
+
+   Stops at the end of the region, at a page already present, or
+   at a page that would have to be read from its file or from
+   swap on disk, so that a fault never waits for more disk reads
+   than its own.  Pages of a file that is already resident in a
+   shared frame just join it, and after a read fault zero-fill
+   pages map the zero page, like the faulting page.  Others,
+   including pages kept compressed in memory by swap, need a new
+   frame, and only free frames up to a share of the user pool are
+   used, so that fault-around never evicts anything.  The caller
+   holds the paging lock. */
+static void
+page_fault_around (struct process *p, uint8_t *upage, bool write,
+                   bool swapped, size_t first)
+{
+  struct fault_stream *s = fault_stream_find (p, upage);
+  size_t budget = palloc_free_cnt (PAL_USER) / FAULT_AROUND_SHARE;
+  size_t window = s->window;
+  size_t i;
+
+  if (swapped && window < SWAP_CLUSTER - 1)
+    window = SWAP_CLUSTER - 1;
+  for (i = first; i <= window; i++)
+    {
+      struct page *page = page_lookup (p, upage + i * PGSIZE);
+
+      if (page == NULL || page->frame != NULL || page_is_zero_mapped (page)
+          || page_reads_disk (page))
+        break;
+      if (page_shared_frame (page) == NULL
+          && (write || page->file != NULL || page->swap_slot != SWAP_NONE))
+        {
+          if (budget == 0)
+            break;
+          budget--;
+        }
+      if (!page_in (page, write))
+        break;
+      if (page->frame != NULL)
+        page->frame->pin_cnt--;
+    }
+  s->next = upage + i * PGSIZE;
+}
+
+/* Returns the stream of P's sequential faults that a fault at
+   UPAGE continues, with its window doubled, or else replaces the
+   stream with the smallest window by a new one. */
+static struct fault_stream *
+fault_stream_find (struct process *p, uint8_t *upage)
+{
+  struct fault_stream *s, *victim = p->fault_streams;
+
+  for (s = p->fault_streams; s < p->fault_streams + FAULT_STREAM_CNT; s++)
+    {
+      if (s->next == upage)
+        {
+          if (s->window < FAULT_AROUND_MAX)
+            s->window *= 2;
+          return s;
+        }
+      if (s->window < victim->window)
+        victim = s;
+    }
+  victim->window = 1;
+  return victim;
+}
+
+/* Returns the frame already caching shared PAGE's part of its
+   file, or a null pointer if there is none or PAGE is private.
+   Writable pages and read-only text look in separate frames.
+   A frame whose pages read a different number of bytes from the
+   file, as when a read-only segment ends partway through a page
+   that is also mapped in full, does not count. */
+static struct frame *
+page_shared_frame (struct page *page)
+{
+  struct frame *f;
+  struct page *other;
+
+  if (!page->shared)
+    return NULL;
+  f = frame_lookup (file_get_inode (page->file), page->ofs, page->writable);
+  if (f == NULL)
+    return NULL;
+  other = list_entry (list_front (&f->pages), struct page, frame_elem);
+  return other->read_bytes == page->read_bytes ? f : NULL;
+}
+
+/* Returns true if PAGE, of the current process, maps the zero
+   page. */
+static bool
+page_is_zero_mapped (struct page *page)
+{
+  return (page->frame == NULL
+          && pagedir_get_page (page->pagedir, page->upage) == zero_kpage);
+}
+
+/* Returns true if bringing PAGE into memory means reading its
+   file or the swap disk, rather than finding it in a frame, in
+   compressed swap, or all zeros. */
+static bool
+page_reads_disk (struct page *page)
+{
+  if (page_shared_frame (page) != NULL)
+    return false;
+  if (page->swap_slot != SWAP_NONE)
+    return swap_on_disk (page->swap_slot);
+  return page->file != NULL && page->read_bytes > 0;
+}
+
+/* Records that PAGE is held in frame F, or in none if F is null,
+   keeping count of the pages its process has resident. */
+static void
+page_set_frame (struct page *page, struct frame *f)
+{
+  struct process *p = page->process;
+
+  if (page->frame == NULL && f != NULL)
+    {
+      if (++p->resident_cnt > p->usage.maxrss)
+        p->usage.maxrss = p->resident_cnt;
+    }
+  else if (page->frame != NULL && f == NULL)
+    p->resident_cnt--;
+  page->frame = f;
+}
+
+/* Charges the timer ticks since START, when the current thread
+   began paging I/O, to its process's usage. */
+static void
+page_charge_io (int64_t start)
+{
+  struct process *p = process_current ();
+
+  if (p != NULL)
+    p->usage.iowait += timer_elapsed (start);
+}
+
+/* Writes shared PAGE's frame back to its part of its file. */
+static void
+page_write_back (struct page *page)
+{
+  int64_t start = timer_ticks ();
+
+  file_write_at (page->file, page->frame->kpage, page->read_bytes,
+                 page->ofs);
+  page_charge_io (start);
+}
+
+/* Acquires filesys_lock, unless the current thread already holds
+   it because it faulted during a file system call, and then the
+   paging lock.  Returns true if it acquired filesys_lock. */
+static bool
+page_acquire (void)
+{
+  bool fs = !lock_held_by_current_thread (&filesys_lock);
+
+  if (fs)
+    lock_acquire (&filesys_lock);
+  lock_acquire (&page_lock);
+  return fs;
+}
+
+/* Releases the locks taken by page_acquire(), which returned
+   FS. */
+static void
+page_release (bool fs)
+{
+  lock_release (&page_lock);
+  if (fs)
+    lock_release (&filesys_lock);
+}
+
+/* Returns P's page at UPAGE, or a null pointer if it has none. */
+static struct page *
+page_lookup (struct process *p, const void *upage)
+{
+  struct page key;
+  struct hash_elem *e;
+
+  key.upage = (void *) upage;
+  e = hash_find (&p->pages, &key.elem);
+  return e != NULL ? hash_entry (e, struct page, elem) : NULL;
+}
+
+/* Frees page E along with its swap slot, or its frame unless
+   other pages share it. */
+static void
+page_free (struct hash_elem *e, void *aux UNUSED)
+{
+  struct page *page = hash_entry (e, struct page, elem);
+
+  if (page->frame != NULL)
+    {
+      struct frame *f = page->frame;
+
+      if (page->shared && pagedir_is_dirty (page->pagedir, page->upage))
+        page_write_back (page);
+      pagedir_clear_page (page->pagedir, page->upage);
+      list_remove (&page->frame_elem);
+      page_set_frame (page, NULL);
+      if (list_empty (&f->pages))
+        frame_free (f);
+    }
+  else if (page->swap_slot != SWAP_NONE)
+    swap_free (page->swap_slot);
+  else
+    pagedir_clear_page (page->pagedir, page->upage);
+  free (page);
+}
+
+/* Returns a hash value for page E. */
+static unsigned
+page_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct page *page = hash_entry (e, struct page, elem);
+  return hash_bytes (&page->upage, sizeof page->upage);
+}
+
+/* Returns true if page A precedes page B. */
+static bool
+page_less (const struct hash_elem *a_, const struct hash_elem *b_,
+           void *aux UNUSED)
+{
+  const struct page *a = hash_entry (a_, struct page, elem);
+  const struct page *b = hash_entry (b_, struct page, elem);
+  return a->upage < b->upage;
+}
@@ -0,0 +1,63 @@
+#ifndef VM_PAGE_H
+#define VM_PAGE_H
+
+#include <hash.h>
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "filesys/off_t.h"
+
+struct file;
+struct process;
+
+/* A page of a process's virtual address space, present in
+   memory or not.  Records where to find the page's contents
+   whenever it must be brought in. */
+struct page
+  {
+    struct hash_elem elem;      /* Element in the process's pages. */
+    void *upage;                /* User virtual address. */
+    uint32_t *pagedir;          /* Page directory mapping UPAGE. */
+    struct process *process;    /* Process that owns the page. */
+    bool writable;              /* May the process write the page? */
+    bool shared;                /* Shares frames with FILE's other users? */
+    struct frame *frame;        /* Frame holding the page, or NULL. */
+    struct list_elem frame_elem; /* Element in the frame's pages. */
+    size_t swap_slot;           /* Swap slot holding it, or SWAP_NONE. */
+
+    /* Contents when not in a frame or swap: READ_BYTES bytes
+       from FILE at offset OFS, then zeros to the end of the
+       page. */
+    struct file *file;          /* File to read, or NULL for all zeros. */
+    off_t ofs;                  /* Offset in FILE. */
+    size_t read_bytes;          /* Bytes to read from FILE. */
+  };
+
+/* Number of streams of sequential page faults tracked per
+   process for fault-around. */
+#define FAULT_STREAM_CNT 4
+
+/* A run of page faults at ascending addresses. */
+struct fault_stream
+  {
+    uint8_t *next;              /* Fault that would continue the run. */
+    size_t window;              /* Pages mapped ahead on that fault. */
+  };
+
+/* Maximum size of a user stack, in pages. */
+extern size_t stack_page_limit;
+
+void page_init (void);
+void page_table_init (struct hash *);
+void page_table_destroy (struct process *);
+bool page_add (void *upage, struct file *, off_t ofs, size_t read_bytes,
+               bool writable, bool shared);
+void page_remove (void *upage);
+bool page_load (void *addr, bool write);
+bool page_grow_stack (void *addr, const void *esp);
+bool page_pin (const void *addr, size_t size);
+void page_unpin (const void *addr, size_t size);
+size_t page_evict (struct frame *[], size_t cnt);
+
+#endif /* vm/page.h */
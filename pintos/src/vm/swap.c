@@ -0,0 +1,146 @@
+#include "vm/swap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <stdio.h>
+#include "devices/disk.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "vm/zswap.h"
+
+/* Set in a slot that names a compressed page in memory rather
+   than a slot on disk. */
+#define SWAP_RAM ((size_t) 1 << 31)
+
+/* Number of sectors in a page-sized swap slot. */
+#define SECTORS_PER_SLOT (PGSIZE / DISK_SECTOR_SIZE)
+
+/* The swap partition, hd1:1. */
+static struct disk *swap_disk;
+
+/* Swap slots in use. */
+static struct bitmap *swap_slots;
+
+/* Protects swap_slots. */
+static struct lock swap_lock;
+
+/* Initializes swapping to compressed memory and to hd1:1.  If
+   there is no such disk, only pages that compress well can be
+   swapped out. */
+void
+swap_init (void)
+{
+  size_t slot_cnt = 0;
+
+  zswap_init ();
+
+  swap_disk = disk_get (1, 1);
+  if (swap_disk != NULL)
+    slot_cnt = disk_size (swap_disk) / SECTORS_PER_SLOT;
+  else
+    printf ("swap: no hd1:1, swapping to memory only\n");
+  swap_slots = bitmap_create (slot_cnt);
+  if (swap_slots == NULL)
+    PANIC ("swap: bitmap creation failed");
+  lock_init (&swap_lock);
+}
+
+/* Writes the CNT pages at KPAGES, at most SWAP_CLUSTER of them,
+   to free swap slots and stores each page's slot in SLOTS, or
+   SWAP_NONE if swap is full.  Pages that compress well are kept
+   compressed in memory while there is room.  The rest go to disk
+   in a single run of adjacent slots, if one is free, so that
+   they are written in order without seeking and can be read back
+   the same way. */
+void
+swap_out_multiple (const void *kpages[], size_t cnt, size_t slots[])
+{
+  size_t disk_cnt = 0;
+  size_t run;
+  size_t i;
+
+  ASSERT (cnt <= SWAP_CLUSTER);
+
+  for (i = 0; i < cnt; i++)
+    {
+      slots[i] = zswap_store (kpages[i]);
+      if (slots[i] != ZSWAP_NONE)
+        slots[i] |= SWAP_RAM;
+      else
+        disk_cnt++;
+    }
+  if (disk_cnt == 0)
+    return;
+
+  lock_acquire (&swap_lock);
+  run = bitmap_scan_and_flip (swap_slots, 0, disk_cnt, false);
+  for (i = 0; i < cnt; i++)
+    if (slots[i] == ZSWAP_NONE)
+      {
+        if (run != BITMAP_ERROR)
+          slots[i] = run++;
+        else
+          {
+            /* No run is free.  Take whatever slots are. */
+            slots[i] = bitmap_scan_and_flip (swap_slots, 0, 1, false);
+            if (slots[i] == BITMAP_ERROR)
+              slots[i] = SWAP_NONE;
+          }
+      }
+  lock_release (&swap_lock);
+
+  for (i = 0; i < cnt; i++)
+    if (slots[i] != SWAP_NONE && !(slots[i] & SWAP_RAM))
+      disk_write_multiple (swap_disk, slots[i] * SECTORS_PER_SLOT,
+                           kpages[i], SECTORS_PER_SLOT);
+}
+
+/* Reads swap SLOT into the page at KPAGE and frees the slot. */
+void
+swap_in (size_t slot, void *kpage)
+{
+  if (slot & SWAP_RAM)
+    {
+      zswap_load (slot & ~SWAP_RAM, kpage);
+      return;
+    }
+  swap_in_run (slot, &kpage, 1);
+}
+
+/* Reads the CNT adjacent swap slots on disk starting at SLOT, at
+   most SWAP_CLUSTER of them, into the pages at KPAGES with a
+   single disk command, and frees the slots. */
+void
+swap_in_run (size_t slot, void *kpages[], size_t cnt)
+{
+  size_t i;
+
+  ASSERT (swap_on_disk (slot));
+  ASSERT (cnt >= 1 && cnt <= SWAP_CLUSTER);
+
+  disk_read_scattered (swap_disk, slot * SECTORS_PER_SLOT, kpages, cnt,
+                       SECTORS_PER_SLOT);
+  for (i = 0; i < cnt; i++)
+    swap_free (slot + i);
+}
+
+/* Returns true if SLOT is on disk rather than in memory. */
+bool
+swap_on_disk (size_t slot)
+{
+  return slot != SWAP_NONE && !(slot & SWAP_RAM);
+}
+
+/* Frees swap SLOT without reading it. */
+void
+swap_free (size_t slot)
+{
+  if (slot & SWAP_RAM)
+    {
+      zswap_free (slot & ~SWAP_RAM);
+      return;
+    }
+  lock_acquire (&swap_lock);
+  ASSERT (bitmap_test (swap_slots, slot));
+  bitmap_reset (swap_slots, slot);
+  lock_release (&swap_lock);
+}
@@ -0,0 +1,20 @@
+#ifndef VM_SWAP_H
+#define VM_SWAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* A swap slot that holds nothing. */
+#define SWAP_NONE ((size_t) -1)
+
+/* Most pages swapped out together. */
+#define SWAP_CLUSTER 8
+
+void swap_init (void);
+void swap_out_multiple (const void *kpages[], size_t cnt, size_t slots[]);
+void swap_in (size_t slot, void *kpage);
+void swap_in_run (size_t slot, void *kpages[], size_t cnt);
+bool swap_on_disk (size_t slot);
+void swap_free (size_t slot);
+
+#endif /* vm/swap.h */
@@ -0,0 +1,226 @@
+#include "vm/zswap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Compressed pages are kept in a pool of kernel pages, in runs of
+   fixed-size chunks.  A compressed page is identified by the
+   index of its first chunk. */
+
+/* Number of kernel pages in the pool. */
+#define ZSWAP_PAGES 32
+
+/* Size of a chunk, in bytes. */
+#define CHUNK_SIZE 128
+
+/* Number of chunks in the pool. */
+#define CHUNK_CNT (ZSWAP_PAGES * PGSIZE / CHUNK_SIZE)
+
+/* Pages that do not compress to this size or smaller are not
+   worth keeping in memory. */
+#define ZSWAP_MAX (PGSIZE / 2)
+
+/* The pool, or a null pointer if it could not be allocated. */
+static uint8_t *pool;
+
+/* Chunks in use. */
+static struct bitmap *chunks;
+
+/* Compressed size of the page starting at each chunk in use. */
+static uint16_t sizes[CHUNK_CNT];
+
+/* Protects the pool, CHUNKS, SIZES, and the compressor's state. */
+static struct lock zswap_lock;
+
+static size_t lz_compress (const uint8_t *src, uint8_t *dst, size_t cap);
+static void lz_decompress (const uint8_t *src, size_t size, uint8_t *dst);
+
+/* Initializes the compressed swap pool. */
+void
+zswap_init (void)
+{
+  lock_init (&zswap_lock);
+  chunks = bitmap_create (CHUNK_CNT);
+  pool = palloc_get_multiple (0, ZSWAP_PAGES);
+  if (chunks == NULL || pool == NULL)
+    {
+      printf ("zswap: no memory for pool, compression disabled\n");
+      pool = NULL;
+    }
+}
+
+/* Compresses the page at KPAGE into the pool and returns its
+   identifier, or ZSWAP_NONE if it does not compress well or the
+   pool has no room for it. */
+size_t
+zswap_store (const void *kpage)
+{
+  static uint8_t buf[ZSWAP_MAX];
+  size_t size, id = ZSWAP_NONE;
+
+  if (pool == NULL)
+    return ZSWAP_NONE;
+
+  lock_acquire (&zswap_lock);
+  size = lz_compress (kpage, buf, sizeof buf);
+  if (size > 0)
+    {
+      id = bitmap_scan_and_flip (chunks, 0,
+                                 (size + CHUNK_SIZE - 1) / CHUNK_SIZE, false);
+      if (id != BITMAP_ERROR)
+        {
+          memcpy (pool + id * CHUNK_SIZE, buf, size);
+          sizes[id] = size;
+        }
+      else
+        id = ZSWAP_NONE;
+    }
+  lock_release (&zswap_lock);
+  return id;
+}
+
+/* Decompresses page ID into the page at KPAGE and frees ID. */
+void
+zswap_load (size_t id, void *kpage)
+{
+  lock_acquire (&zswap_lock);
+  lz_decompress (pool + id * CHUNK_SIZE, sizes[id], kpage);
+  lock_release (&zswap_lock);
+  zswap_free (id);
+}
+
+/* Frees page ID without decompressing it. */
+void
+zswap_free (size_t id)
+{
+  size_t chunk_cnt;
+
+  lock_acquire (&zswap_lock);
+  chunk_cnt = (sizes[id] + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  ASSERT (bitmap_all (chunks, id, chunk_cnt));
+  bitmap_set_multiple (chunks, id, chunk_cnt, false);
+  lock_release (&zswap_lock);
+}
+
+/* The compressor is a byte-oriented LZ77 variant.  Output is a
+   sequence of groups, each a flag byte followed by up to eight
+   items, one per flag bit from least significant up.  A clear
+   bit is a literal byte.  A set bit is a match: a 12-bit offset
+   back into the output less 1, then a 4-bit length less
+   LZ_MIN_MATCH, where 15 means another byte follows with the
+   rest of the length. */
+
+/* Shortest and longest matches. */
+#define LZ_MIN_MATCH 3
+#define LZ_MAX_MATCH (LZ_MIN_MATCH + 15 + 255)
+
+/* log2 of the number of entries in the match-finder table. */
+#define LZ_HASH_BITS 10
+
+/* Most recent position plus 1 of each hashed 3-byte sequence, or
+   0 if none.  Protected by zswap_lock. */
+static uint16_t lz_table[1 << LZ_HASH_BITS];
+
+/* Returns the lz_table index for the 3 bytes at P. */
+static inline unsigned
+lz_hash (const uint8_t *p)
+{
+  uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+  return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/* Compresses the page at SRC into DST, which has room for CAP
+   bytes.  Returns the compressed size, or 0 if it would exceed
+   CAP. */
+static size_t
+lz_compress (const uint8_t *src, uint8_t *dst, size_t cap)
+{
+  size_t ip = 0, op = 0, flag_ofs = 0;
+  int bit = 8;
+
+  memset (lz_table, 0, sizeof lz_table);
+  while (ip < PGSIZE)
+    {
+      size_t len = 0, match = 0;
+
+      if (bit == 8)
+        {
+          if (op >= cap)
+            return 0;
+          flag_ofs = op++;
+          dst[flag_ofs] = 0;
+          bit = 0;
+        }
+
+      if (ip + LZ_MIN_MATCH <= PGSIZE)
+        {
+          unsigned h = lz_hash (src + ip);
+          if (lz_table[h] != 0)
+            {
+              match = lz_table[h] - 1;
+              while (ip + len < PGSIZE && len < LZ_MAX_MATCH
+                     && src[match + len] == src[ip + len])
+                len++;
+            }
+          lz_table[h] = ip + 1;
+        }
+
+      if (len >= LZ_MIN_MATCH)
+        {
+          size_t ofs = ip - match - 1;
+          size_t extra = len - LZ_MIN_MATCH;
+
+          if (op + (extra >= 15 ? 3 : 2) > cap)
+            return 0;
+          dst[op++] = ofs >> 4;
+          dst[op++] = ((ofs & 0xf) << 4) | (extra >= 15 ? 15 : extra);
+          if (extra >= 15)
+            dst[op++] = extra - 15;
+          dst[flag_ofs] |= 1 << bit;
+          ip += len;
+        }
+      else
+        {
+          if (op >= cap)
+            return 0;
+          dst[op++] = src[ip++];
+        }
+      bit++;
+    }
+  return op;
+}
+
+/* Decompresses the SIZE bytes at SRC, produced by lz_compress(),
+   into the page at DST. */
+static void
+lz_decompress (const uint8_t *src, size_t size, uint8_t *dst)
+{
+  size_t ip = 0, op = 0;
+
+  while (ip < size)
+    {
+      uint8_t flags = src[ip++];
+      int bit;
+
+      for (bit = 0; bit < 8 && ip < size; bit++)
+        if (flags & (1 << bit))
+          {
+            size_t ofs = ((src[ip] << 4) | (src[ip + 1] >> 4)) + 1;
+            size_t len = (src[ip + 1] & 0xf) + LZ_MIN_MATCH;
+
+            ip += 2;
+            if (len == LZ_MIN_MATCH + 15)
+              len += src[ip++];
+            for (; len > 0; len--, op++)
+              dst[op] = dst[op - ofs];
+          }
+        else
+          dst[op++] = src[ip++];
+    }
+  ASSERT (op == PGSIZE);
+}
@@ -0,0 +1,14 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+
+#include <stddef.h>
+
+/* A compressed page that does not exist. */
+#define ZSWAP_NONE ((size_t) -1)
+
+void zswap_init (void);
+size_t zswap_store (const void *kpage);
+void zswap_load (size_t id, void *kpage);
+void zswap_free (size_t id);
+
+#endif /* vm/zswap.h */